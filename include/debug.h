@@ -10,12 +10,14 @@
 //      'g' -- graphics
 //      'c' -- computations
 //      's' -- scheduler
+//      'p' -- placement of tiles and workers (scheduler)
 //      't' -- threads
 //      'o' -- OpenCL
 //      'm' -- monitoring
 //      'i' -- initialization sequence
 //      'u' -- user
 //      'M' -- MPI
+//      'n' -- NUMA memory placement
 
 #include "global.h"
 #include "api_funcs.h"
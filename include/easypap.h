@@ -9,10 +9,13 @@
 #include "arch_flags.h"
 #include "debug.h"
 #include "error.h"
+#include "mem_policy.h"
 #include "monitoring.h"
 #include "ocl.h"
 #include "pthread_barrier.h"
+#include "spin_barrier.h"
 #include "scheduler.h"
+#include "team.h"
 #include "minmax.h"
 
 #ifdef ENABLE_MPI
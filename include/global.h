@@ -26,6 +26,7 @@ extern unsigned do_first_touch;
 extern int max_iter;
 extern char *easypap_image_file;
 extern char *draw_param;
+extern char *kernel_arg;
 
 extern unsigned opencl_used;
 extern unsigned easypap_mpirun;
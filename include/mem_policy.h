@@ -0,0 +1,33 @@
+#ifndef MEM_POLICY_IS_DEF
+#define MEM_POLICY_IS_DEF
+
+#include <stddef.h>
+
+// NUMA placement of the main data arrays.
+//
+// By default, pages are placed on the node of the thread which touches them
+// first (see the --first-touch option and the <kernel>_ft hooks). When the
+// --interleave option is used, mem_policy_apply spreads the pages of an area
+// across all NUMA nodes in a round-robin fashion.
+
+extern unsigned do_interleave;
+
+// Use the topology already loaded by main (a hwloc_topology_t)
+struct hwloc_topology;
+void mem_policy_init (struct hwloc_topology *topo);
+
+// Apply the memory policy to an area which has not been touched yet
+void mem_policy_apply (void *addr, size_t len);
+
+// Register an area so that its placement is reported at the end of the run
+void mem_policy_register (const char *name, void *addr, size_t len);
+
+// Print (debug flag 'n') the amount of memory each NUMA node holds for the
+// registered areas, and an estimate (not a measurement) of the bandwidth each
+// node must sustain, assuming every iteration streams these areas exactly
+// once
+void mem_policy_report (unsigned nb_iter, long time_in_us);
+
+void mem_policy_clean (void);
+
+#endif
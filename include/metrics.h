@@ -0,0 +1,64 @@
+#ifndef METRICS_IS_DEF
+#define METRICS_IS_DEF
+
+#include <stdint.h>
+
+// Work counters.
+//
+// Tile functions count the work they do with metrics_add. There is no
+// synchronization: each thread (identified by the 'who' argument of tile
+// functions) owns a cache line of counters. Counters of all threads are
+// summed by monitoring_end_iteration, recorded in the trace (if any), and
+// their totals are appended as extra columns to the performance CSV file,
+// from which effective GUPS and bandwidth can be derived. Metrics that no
+// tile function ever counted are left empty in the CSV file rather than
+// reported as 0.
+
+typedef enum
+{
+  METRIC_CELLS,   // cells updated
+  METRIC_TOPPLES, // topplings (sandpile)
+  METRIC_SKIPPED, // tiles skipped
+  METRIC_BYTES,   // bytes touched
+  METRIC_NB
+} metric_t;
+
+// Also used as CSV column names
+extern char *metric_names[METRIC_NB + 1];
+
+// Totals since the beginning of the run
+extern uint64_t metrics_total[METRIC_NB];
+
+// Bit m is set once metric m has been counted by some tile function
+extern uint64_t metrics_counted;
+
+#ifdef ENABLE_MONITORING
+
+typedef struct
+{
+  uint64_t count[METRIC_NB];
+  uint64_t counted;
+} __attribute__ ((aligned (64))) metrics_slot_t;
+
+extern metrics_slot_t *metrics_slots;
+
+static inline void metrics_add (unsigned who, metric_t m, uint64_t n)
+{
+  metrics_slots[who].count[m] += n;
+  metrics_slots[who].counted |= 1ULL << m;
+}
+
+void metrics_init (unsigned nb_threads);
+void metrics_end_iteration (void);
+void metrics_finalize (void);
+
+#else
+
+#define metrics_add(who, m, n) (void)0
+#define metrics_init(n) (void)0
+#define metrics_end_iteration() (void)0
+#define metrics_finalize() (void)0
+
+#endif
+
+#endif
@@ -2,6 +2,7 @@
 #define MONITORING_IS_DEF
 
 #include "gmonitor.h"
+#include "metrics.h"
 #include "time_macros.h"
 #include "trace_record.h"
 
@@ -12,131 +13,111 @@ static inline void monitoring_declare_task_ids (char *task_ids[])
   trace_record_declare_task_ids (task_ids);
 }
 
+// The trace recorder takes its own (cheaper) timestamps: what_time_is_it is
+// only called when the graphical monitor is on
+
 #ifdef ENABLE_SDL
 
 static inline long monitoring_start_iteration (void)
 {
-  if (do_gmonitor | do_trace) {
-    long t = what_time_is_it ();
+  long t = 0;
+
+  if (do_gmonitor) {
+    t = what_time_is_it ();
     gmonitor_start_iteration (t);
-    trace_record_start_iteration (t);
-    return t;
-  } else
-    return 0;
+  }
+  trace_record_start_iteration ();
+
+  return t;
 }
 
 static inline long monitoring_end_iteration (void)
 {
-  if (do_gmonitor | do_trace) {
-    long t = what_time_is_it ();
+  long t = 0;
+
+  if (do_gmonitor) {
+    t = what_time_is_it ();
     gmonitor_end_iteration (t);
-    trace_record_end_iteration (t);
-    return t;
-  } else
-    return 0;
+  }
+  trace_record_end_iteration ();
+  metrics_end_iteration ();
+
+  return t;
 }
 
 static inline void monitoring_start_tile (unsigned cpu)
 {
-  if (do_gmonitor | do_trace) {
-    long t = what_time_is_it ();
-    gmonitor_start_tile (t, cpu);
-    trace_record_start_tile (t, cpu);
-  }
+  if (do_gmonitor)
+    gmonitor_start_tile (what_time_is_it (), cpu);
+  trace_record_start_tile (cpu);
 }
 
 static inline void monitoring_end_tile (unsigned x, unsigned y, unsigned w,
                                         unsigned h, unsigned cpu)
 {
-  if (do_gmonitor | do_trace) {
-    long t = what_time_is_it ();
-    gmonitor_end_tile (t, cpu, x, y, w, h);
-    trace_record_end_tile (t, cpu, x, y, w, h, TASK_TYPE_COMPUTE, 0);
-  }
+  if (do_gmonitor)
+    gmonitor_end_tile (what_time_is_it (), cpu, x, y, w, h);
+  trace_record_end_tile (cpu, x, y, w, h, TASK_TYPE_COMPUTE, 0);
 }
 
 static inline void monitoring_end_tile_id (unsigned x, unsigned y, unsigned w,
                                            unsigned h, unsigned cpu,
                                            unsigned task_id)
 {
-  if (do_gmonitor | do_trace) {
-    long t = what_time_is_it ();
-    gmonitor_end_tile (t, cpu, x, y, w, h);
-    trace_record_end_tile (t, cpu, x, y, w, h, TASK_TYPE_COMPUTE, task_id + 1);
-  }
+  if (do_gmonitor)
+    gmonitor_end_tile (what_time_is_it (), cpu, x, y, w, h);
+  trace_record_end_tile (cpu, x, y, w, h, TASK_TYPE_COMPUTE, task_id + 1);
 }
 
 static inline void monitoring_gpu_tile (unsigned x, unsigned y, unsigned w,
                                         unsigned h, unsigned cpu, long start,
                                         long end, task_type_t task_type)
 {
-  if (do_gmonitor | do_trace) {
-    if (task_type == TASK_TYPE_COMPUTE)
-      gmonitor_start_tile (start, cpu);
-    trace_record_start_tile (start, cpu);
-    if (task_type == TASK_TYPE_COMPUTE)
-      gmonitor_end_tile (end, cpu, x, y, w, h);
-    trace_record_end_tile (end, cpu, x, y, w, h, task_type, 0 /* task id */);
+  if (do_gmonitor && task_type == TASK_TYPE_COMPUTE) {
+    gmonitor_start_tile (start, cpu);
+    gmonitor_end_tile (end, cpu, x, y, w, h);
   }
+  trace_record_gpu_tile (start, end, cpu, x, y, w, h, task_type);
 }
 
 #else // no SDL
 
 static inline long monitoring_start_iteration (void)
 {
-  if (do_trace) {
-    long t = what_time_is_it ();
-    trace_record_start_iteration (t);
-    return t;
-  } else
-    return 0;
+  trace_record_start_iteration ();
+  return 0;
 }
 
 static inline long monitoring_end_iteration (void)
 {
-  if (do_trace) {
-    long t = what_time_is_it ();
-    trace_record_end_iteration (t);
-    return t;
-  } else
-    return 0;
+  trace_record_end_iteration ();
+  metrics_end_iteration ();
+  return 0;
 }
 
 static inline void monitoring_start_tile (unsigned cpu)
 {
-  if (do_trace) {
-    long t = what_time_is_it ();
-    trace_record_start_tile (t, cpu);
-  }
+  trace_record_start_tile (cpu);
 }
 
 static inline void monitoring_end_tile (unsigned x, unsigned y, unsigned w,
                                         unsigned h, unsigned cpu)
 {
-  if (do_trace) {
-    long t = what_time_is_it ();
-    trace_record_end_tile (t, cpu, x, y, w, h, TASK_TYPE_COMPUTE, 0);
-  }
+  trace_record_end_tile (cpu, x, y, w, h, TASK_TYPE_COMPUTE, 0);
 }
 
 static inline void monitoring_end_tile_id (unsigned x, unsigned y, unsigned w,
                                            unsigned h, unsigned cpu,
                                            unsigned task_id)
 {
-  if (do_trace) {
-    long t = what_time_is_it ();
-    trace_record_end_tile (t, cpu, x, y, w, h, TASK_TYPE_COMPUTE, task_id + 1);
-  }
+  trace_record_end_tile (cpu, x, y, w, h, TASK_TYPE_COMPUTE, task_id + 1);
 }
 
 static inline void monitoring_gpu_tile (unsigned x, unsigned y, unsigned w,
                                         unsigned h, unsigned cpu, long start,
                                         long end, task_type_t task_type)
 {
-  if (do_trace) {
-    trace_record_start_tile (start, cpu);
-    trace_record_end_tile (end, cpu, x, y, w, h, task_type, 0 /* task id */);
-  }
+  trace_record_gpu_tile (start, end, cpu, x, y, w, h, task_type);
 }
 
 #endif
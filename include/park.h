@@ -0,0 +1,22 @@
+#ifndef PARK_IS_DEF
+#define PARK_IS_DEF
+
+// Blocking primitives for threads which spin for a while before sleeping.
+//
+// park_wait blocks the calling thread as long as *addr == val (it may also
+// return spuriously), park_wake wakes up at most n threads blocked on addr.
+// On Linux they are thin wrappers around the futex system call.
+
+void park_wait (int *addr, int val);
+void park_wake (int *addr, int n);
+
+static inline void cpu_relax (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause ();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+#endif
@@ -1,19 +1,21 @@
-
 #ifndef PTHREAD_DISTRIB
 #define PTHREAD_DISTRIB
 
 #include <pthread.h>
 
+#include "spin_barrier.h"
+
+// Elements are handed out with an atomic counter. Once all elements have
+// been distributed, pthread_distrib_get waits for all threads (spinning
+// then blocking) and returns -1; the last thread calls finalize_func and
+// resets the distributor for the next phase.
+
 typedef struct
 {
-  pthread_mutex_t mutex;
-  pthread_cond_t cond;
-  unsigned int limit;
-  unsigned int count;
-  unsigned int phase;
+  unsigned int next_element __attribute__ ((aligned (SPIN_BARRIER_LINE)));
   unsigned int total_elements;
-  unsigned int next_element;
   void (*finalize_func) (void);
+  spin_barrier_t barrier;
 } pthread_distrib_t;
 
 int pthread_distrib_init (pthread_distrib_t *distrib, unsigned nb_threads,
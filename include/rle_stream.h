@@ -0,0 +1,30 @@
+#ifndef RLE_STREAM_IS_DEF
+#define RLE_STREAM_IS_DEF
+
+#include "rle_lexer.h"
+
+// Streaming RLE loader and generator.
+//
+// Unlike rle_lexer_parse, which calls a function for every live cell, the
+// file is mapped in memory and each run of live cells is written at once
+// into the row it belongs to (memset-like). Likewise, rle_stream_generate
+// scans whole rows for runs and writes the output through a buffer.
+//
+// Rows are reached through a rle_row_func_t, which returns the address of
+// cell (y, 0), laid out according to one of the following formats.
+
+#define RLE_LAYOUT_CELLS 0 // one unsigned per cell, 1 for living cells
+#define RLE_LAYOUT_BITS 1  // 64 cells per uint64_t: bit x % 64 of word x / 64
+
+typedef void *(*rle_row_func_t) (int y);
+
+// Same semantics as rle_lexer_parse. Cells falling outside the DIM x DIM
+// area are ignored.
+void rle_stream_parse (char *filename, int xo, int yo, int orientation,
+                       int layout, rle_row_func_t row);
+
+// Produces the same file as rle_generate
+void rle_stream_generate (int x, int y, int width, int height, int layout,
+                          rle_row_func_t row, char *filename);
+
+#endif
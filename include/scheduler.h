@@ -1,6 +1,7 @@
 #ifndef SCHEDULER_IS_DEF
 #define SCHEDULER_IS_DEF
 
+#include <stddef.h>
 
 typedef void (*task_func_t)(void *, unsigned);
 
@@ -8,7 +9,44 @@ unsigned scheduler_init (unsigned default_P);
 void scheduler_finalize (void);
 
 void scheduler_task_wait (void);
+
+// Worker owning tile (tx, ty): tiles close to each other are owned by the
+// same worker or by workers sharing caches. Tasks working on a tile should
+// be submitted to its owner to keep its data warm across iterations.
+unsigned scheduler_tile_owner (unsigned tx, unsigned ty);
 void scheduler_create_task (task_func_t task, void *param, unsigned cpu);
 
+// Submits nb tasks at once: task i receives (char *)params + i * stride as
+// parameter. Using params == NULL and stride == 1 passes i itself.
+void scheduler_create_tasks (task_func_t task, void *params, size_t stride,
+                             unsigned nb, unsigned cpu);
+
+// Parallel loops over tiles. The policy is initialized from OMP_SCHEDULE.
+typedef enum
+{
+  SCHED_STATIC,
+  SCHED_DYNAMIC,
+  SCHED_GUIDED
+} sched_policy_t;
+
+typedef enum
+{
+  REDUCTION_OR,
+  REDUCTION_SUM
+} reduction_t;
+
+// Same signature as the usual do_tile functions: returns the value to reduce
+typedef int (*tile_func_t) (int x, int y, int width, int height, int who);
+
+void scheduler_set_policy (sched_policy_t policy, unsigned chunk);
+
+// Calls fn on every tile, and returns the reduction of the results
+int scheduler_parallel_for_tiles (tile_func_t fn, reduction_t red);
+
+// Same, on tiles (ox + i * step, oy + j * step) only (tile coordinates)
+int scheduler_parallel_for_tile_subset (tile_func_t fn, reduction_t red,
+                                        unsigned ox, unsigned oy,
+                                        unsigned step);
+
 
 #endif
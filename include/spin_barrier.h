@@ -0,0 +1,28 @@
+#ifndef SPIN_BARRIER_IS_DEF
+#define SPIN_BARRIER_IS_DEF
+
+#include <pthread.h>
+
+// Sense-reversing barrier: threads spin for a while on a flag which the last
+// thread to arrive flips, then block on it. Counter and flag live on
+// separate cache lines.
+
+#define SPIN_BARRIER_LINE 64
+
+typedef struct
+{
+  int count __attribute__ ((aligned (SPIN_BARRIER_LINE))); // threads to come
+  int sense __attribute__ ((aligned (SPIN_BARRIER_LINE))); // flipped each phase
+  int nb_parked;
+  unsigned limit;
+} __attribute__ ((aligned (SPIN_BARRIER_LINE))) spin_barrier_t;
+
+int spin_barrier_init (spin_barrier_t *barrier, unsigned count);
+
+// Returns PTHREAD_BARRIER_SERIAL_THREAD in exactly one thread, 0 in others
+int spin_barrier_wait (spin_barrier_t *barrier);
+
+// Same, and the last thread to arrive calls f before releasing the others
+int spin_barrier_single (spin_barrier_t *barrier, void (*f) (void));
+
+#endif
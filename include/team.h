@@ -0,0 +1,47 @@
+#ifndef TEAM_IS_DEF
+#define TEAM_IS_DEF
+
+#include "scheduler.h"
+
+// Persistent thread team.
+//
+// Instead of opening one (or more) OpenMP parallel regions per iteration,
+// team_run opens a single one for all the iterations of a compute call.
+// Threads then only synchronize with a spin barrier between phases, and
+// agree on convergence through a shared flag.
+//
+// Kernels opt in by calling team_init from their init hook: in the
+// non-graphical loop, the whole run is then handed over to a single
+// compute call when no iteration count is given (see -i and -r).
+
+void team_init (void);
+void team_finalize (void);
+
+// Returns 1 if the current variant called team_init
+int team_enabled (void);
+
+// Calls body in all the threads of the team, then end_of_iteration (which
+// may be NULL) in a single thread while the others wait, for it = 1 up to
+// nb_iter. Returns the first iteration during which no change was reported,
+// or 0.
+unsigned team_run (unsigned nb_iter, void (*body) (void),
+                   void (*end_of_iteration) (void));
+
+// The following functions must be called by all threads from within body.
+
+// Calls fn on every tile, tiles being distributed according to
+// OMP_SCHEDULE. A nonzero value returned by fn marks the current iteration
+// as changed. There is no implicit barrier: call team_barrier between
+// dependent phases (one is always done after body).
+void team_for_tiles (tile_func_t fn);
+
+// Same, on tiles (ox + i * step, oy + j * step) only (tile coordinates)
+void team_for_tile_subset (tile_func_t fn, unsigned ox, unsigned oy,
+                           unsigned step);
+
+void team_barrier (void);
+
+// Marks the current iteration as changed
+void team_changed (void);
+
+#endif
@@ -49,6 +49,18 @@ unsigned blur_compute_seq (unsigned nb_iter)
   return 0;
 }
 
+// Used with --first-touch: each tile is touched by the thread which computes
+// it when tiles are distributed by a static OpenMP schedule
+void blur_ft (void)
+{
+#pragma omp parallel for collapse(2) schedule(runtime)
+  for (int y = 0; y < DIM; y += TILE_H)
+    for (int x = 0; x < DIM; x += TILE_W)
+      for (int i = y; i < y + TILE_H; i++)
+        for (int j = x; j < x + TILE_W; j++)
+          cur_img (i, j) = next_img (i, j) = 0;
+}
+
 ///////////////////////////// Tiled sequential version (tiled)
 // Suggested cmdline(s):
 // ./run -l images/1024.png -k blur -v tiled -ts 32 -m si
@@ -1,9 +1,10 @@
 
 #include "easypap.h"
-#include "rle_lexer.h"
+#include "rle_stream.h"
 
 #include <omp.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <unistd.h>
@@ -38,6 +39,11 @@ void life_init (void)
 
     _alternate_table = mmap (NULL, size, PROT_READ | PROT_WRITE,
                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    mem_policy_apply (_table, size);
+    mem_policy_apply (_alternate_table, size);
+    mem_policy_register ("table", _table, size);
+    mem_policy_register ("alternate_table", _alternate_table, size);
   }
 }
 
@@ -49,6 +55,20 @@ void life_finalize (void)
   munmap (_alternate_table, size);
 }
 
+// Used with --first-touch: each tile is touched by the thread which computes
+// it when tiles are distributed by a static OpenMP schedule
+void life_ft (void)
+{
+#pragma omp parallel for collapse(2) schedule(runtime)
+  for (int y = 0; y < DIM; y += TILE_H)
+    for (int x = 0; x < DIM; x += TILE_W)
+      for (int i = y; i < y + TILE_H; i++)
+        for (int j = x; j < x + TILE_W; j++) {
+          cur_table (i, j) = next_table (i, j) = 0;
+          cur_img (i, j) = next_img (i, j) = 0;
+        }
+}
+
 // This function is called whenever the graphical window needs to be refreshed
 void life_refresh_img (void)
 {
@@ -102,6 +122,9 @@ unsigned life_compute_seq (unsigned nb_iter)
 
     monitoring_end_tile (0, 0, DIM, DIM, 0);
 
+    metrics_add (0, METRIC_CELLS, DIM * DIM);
+    metrics_add (0, METRIC_BYTES, 2 * DIM * DIM * sizeof (cell_t));
+
     swap_tables ();
 
     if (!change)
@@ -135,6 +158,10 @@ static int do_tile (int x, int y, int width, int height, int who)
 
   monitoring_end_tile (x, y, width, height, who);
 
+  // Each cell is read once from _table and written once to _alternate_table
+  metrics_add (who, METRIC_CELLS, width * height);
+  metrics_add (who, METRIC_BYTES, 2 * width * height * sizeof (cell_t));
+
   return r;
 }
 
@@ -160,32 +187,953 @@ unsigned life_compute_tiled (unsigned nb_iter)
   return res;
 }
 
+///////////////////////////// Pthread version (pthread)
+// Tiles are distributed to the workers of src/scheduler.c according to
+// OMP_SCHEDULE, so that this variant can be compared to an OpenMP one using
+// schedule(runtime).
+// Suggested cmdline(s):
+// OMP_SCHEDULE=dynamic ./run -k life -v pthread -a random -s 1024 -ts 32 -n
+//
+void life_init_pthread (void)
+{
+  life_init ();
+  scheduler_init (-1);
+}
+
+void life_finalize_pthread (void)
+{
+  scheduler_finalize ();
+  life_finalize ();
+}
+
+unsigned life_compute_pthread (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = scheduler_parallel_for_tiles (do_tile, REDUCTION_OR);
+
+    swap_tables ();
+
+    if (!change) { // we stop when all cells are stable
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
+///////////////////////////// Persistent team version (team)
+// A single OpenMP parallel region spans all iterations: threads only meet at
+// a spin barrier, where the last one swaps the tables (see include/team.h).
+// Suggested cmdline(s):
+// ./run -k life -v team -a random -s 256 -ts 16 -n
+//
+void life_init_team (void)
+{
+  life_init ();
+  team_init ();
+}
+
+void life_finalize_team (void)
+{
+  team_finalize ();
+  life_finalize ();
+}
+
+static void team_body (void)
+{
+  team_for_tiles (do_tile);
+}
+
+unsigned life_compute_team (unsigned nb_iter)
+{
+  return team_run (nb_iter, team_body, swap_tables);
+}
+
+///////////////////////////// Lazy tiled version (lazy)
+// The cells of a tile can only change if some tile of its 3x3 neighborhood
+// (itself included) changed during the previous generation: other tiles are
+// skipped. This does not break swap_tables: a skipped tile did not change
+// during the previous generation either, so both tables already hold the
+// same values in it.
+// Suggested cmdline(s):
+// ./run -k life -v lazy_omp -a otca_off -s 2176 -ts 32 -n
+//
+static unsigned char *restrict _dirty = NULL, *restrict _next_dirty = NULL;
+static unsigned long lazy_computed = 0, lazy_skipped = 0;
+
+#define dirty(ty, tx) (_dirty[(ty) * NB_TILES_X + (tx)])
+#define next_dirty(ty, tx) (_next_dirty[(ty) * NB_TILES_X + (tx)])
+
+void life_init_lazy (void)
+{
+  life_init ();
+
+  if (_dirty == NULL) {
+    _dirty      = malloc (NB_TILES_X * NB_TILES_Y);
+    _next_dirty = malloc (NB_TILES_X * NB_TILES_Y);
+
+    // The first generation computes all tiles
+    memset (_dirty, 1, NB_TILES_X * NB_TILES_Y);
+  }
+}
+
+void life_finalize_lazy (void)
+{
+  unsigned long total = lazy_computed + lazy_skipped;
+
+  PRINT_DEBUG ('u', "Lazy: %lu/%lu tiles skipped (%.1f%%)\n", lazy_skipped,
+               total, total ? 100.0 * lazy_skipped / total : 0.0);
+
+  free (_dirty);
+  free (_next_dirty);
+  life_finalize ();
+}
+
+void life_init_lazy_omp (void)
+{
+  life_init_lazy ();
+}
+
+void life_finalize_lazy_omp (void)
+{
+  life_finalize_lazy ();
+}
+
+static inline void swap_dirty (void)
+{
+  unsigned char *tmp = _dirty;
+
+  _dirty      = _next_dirty;
+  _next_dirty = tmp;
+}
+
+static inline int neighborhood_dirty (int tx, int ty)
+{
+  for (int i = max (ty - 1, 0); i <= min (ty + 1, (int)NB_TILES_Y - 1); i++)
+    for (int j = max (tx - 1, 0); j <= min (tx + 1, (int)NB_TILES_X - 1); j++)
+      if (dirty (i, j))
+        return 1;
+
+  return 0;
+}
+
+// Computes tile (tx, ty) if needed. Returns 1 if it was skipped.
+static int do_tile_lazy (int tx, int ty, int who)
+{
+  if (!neighborhood_dirty (tx, ty)) {
+    next_dirty (ty, tx) = 0;
+    metrics_add (who, METRIC_SKIPPED, 1);
+    return 1;
+  }
+
+  next_dirty (ty, tx) =
+      do_tile (tx * TILE_W, ty * TILE_H, TILE_W, TILE_H, who);
+
+  return 0;
+}
+
+// Accounts for skipped tiles and swaps tables. Returns 0 if no tile changed.
+static int lazy_end_of_iteration (unsigned skipped)
+{
+  const unsigned nb_tiles = NB_TILES_X * NB_TILES_Y;
+  int change              = 0;
+
+  for (int t = 0; t < nb_tiles && !change; t++)
+    change = _next_dirty[t];
+
+  lazy_skipped += skipped;
+  lazy_computed += nb_tiles - skipped;
+
+  swap_tables ();
+  swap_dirty ();
+
+  return change;
+}
+
+unsigned life_compute_lazy (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    unsigned skipped = 0;
+
+    for (int ty = 0; ty < NB_TILES_Y; ty++)
+      for (int tx = 0; tx < NB_TILES_X; tx++)
+        skipped += do_tile_lazy (tx, ty, 0);
+
+    if (!lazy_end_of_iteration (skipped)) { // all cells are stable
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
+unsigned life_compute_lazy_omp (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    unsigned skipped = 0;
+
+#pragma omp parallel for collapse(2) schedule(runtime) reduction(+ : skipped)
+    for (int ty = 0; ty < NB_TILES_Y; ty++)
+      for (int tx = 0; tx < NB_TILES_X; tx++)
+        skipped += do_tile_lazy (tx, ty, omp_get_thread_num ());
+
+    if (!lazy_end_of_iteration (skipped)) { // all cells are stable
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
+///////////////////////////// Bit-packed version (bit)
+// 64 cells are packed in each 64-bit word: bit b of word w in row y is cell
+// (y, w * 64 + b). The 8 neighbors of 64 cells are summed at once with
+// bit-sliced adders. _table is not even allocated: the initial
+// configuration is directly packed by set_cell, and life_refresh_img_bit
+// unpacks cells into cur_img.
+//
+// Tiles are widened to a multiple of 64 cells.
+// Suggested cmdline(s):
+// ./run -k life -v bit_omp -s 6208 -a meta3x3 -ts 64 -r 50 -si
+//
+typedef uint64_t bits_t;
+
+#define BITS 64
+
+static bits_t *restrict _bits = NULL, *restrict _alternate_bits = NULL;
+static bits_t *col_mask    = NULL;
+static unsigned nb_words   = 0; // per row
+static unsigned bit_tile_w = 0;
+
+// Each row is padded with an empty word on each side
+#define bits_stride (nb_words + 2)
+#define cur_bits(y, w) (_bits[(y)*bits_stride + (w) + 1])
+#define next_bits(y, w) (_alternate_bits[(y)*bits_stride + (w) + 1])
+
+static void bits_alloc (void)
+{
+  if (_bits == NULL) {
+    nb_words          = (DIM + BITS - 1) / BITS;
+    bit_tile_w        = (TILE_W + BITS - 1) / BITS * BITS;
+    const size_t size = DIM * bits_stride * sizeof (bits_t);
+
+    PRINT_DEBUG ('u', "Memory footprint = 2 x %zu bytes\n", size);
+
+    _bits = mmap (NULL, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    _alternate_bits = mmap (NULL, size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    mem_policy_apply (_bits, size);
+    mem_policy_apply (_alternate_bits, size);
+    mem_policy_register ("bits", _bits, size);
+    mem_policy_register ("alternate_bits", _alternate_bits, size);
+
+    // Cells of columns 0 and DIM - 1 never change, and there is nothing
+    // beyond DIM - 1
+    col_mask = malloc (nb_words * sizeof (bits_t));
+    for (int w = 0; w < nb_words; w++)
+      col_mask[w] = ~(bits_t)0;
+    col_mask[0] &= ~(bits_t)1;
+    col_mask[nb_words - 1] &= ((bits_t)1 << ((DIM - 1) % BITS)) - 1;
+  }
+}
+
+void life_init_bit (void)
+{
+  bits_alloc ();
+}
+
+void life_finalize_bit (void)
+{
+  const size_t size = DIM * bits_stride * sizeof (bits_t);
+
+  munmap (_bits, size);
+  munmap (_alternate_bits, size);
+  free (col_mask);
+}
+
+void life_init_bit_omp (void)
+{
+  life_init_bit ();
+}
+
+void life_finalize_bit_omp (void)
+{
+  life_finalize_bit ();
+}
+
+void life_ft_bit (void)
+{
+#pragma omp parallel for collapse(2) schedule(runtime)
+  for (int y = 0; y < DIM; y += TILE_H)
+    for (int x = 0; x < DIM; x += bit_tile_w) {
+      for (int i = y; i < y + TILE_H; i++) {
+        for (int w = x / BITS; w < (x + bit_tile_w) / BITS && w < nb_words;
+             w++)
+          cur_bits (i, w) = next_bits (i, w) = 0;
+        for (int j = x; j < x + bit_tile_w && j < DIM; j++)
+          cur_img (i, j) = next_img (i, j) = 0;
+      }
+    }
+}
+
+void life_ft_bit_omp (void)
+{
+  life_ft_bit ();
+}
+
+void life_refresh_img_bit (void)
+{
+  for (int i = 0; i < DIM; i++)
+    for (int w = 0; w < nb_words; w++) {
+      bits_t b = cur_bits (i, w);
+
+      for (int j = w * BITS; j < (w + 1) * BITS && j < DIM; j++, b >>= 1)
+        cur_img (i, j) = (b & 1) * color;
+    }
+}
+
+void life_refresh_img_bit_omp (void)
+{
+  life_refresh_img_bit ();
+}
+
+static inline void swap_bits (void)
+{
+  bits_t *tmp = _bits;
+
+  _bits           = _alternate_bits;
+  _alternate_bits = tmp;
+}
+
+// Computes the next state of 64 cells, given their 8 neighbors
+static inline bits_t bits_rule (bits_t nw, bits_t n, bits_t ne, bits_t w,
+                                bits_t me, bits_t e, bits_t sw, bits_t s,
+                                bits_t se)
+{
+  // Full adders on the 3 rows of neighbors
+  bits_t x0 = nw ^ n, s0 = x0 ^ ne, c0 = (nw & n) | (x0 & ne);
+  bits_t x1 = w ^ e, s1 = x1 ^ sw, c1 = (w & e) | (x1 & sw);
+  bits_t s2 = s ^ se, c2 = s & se;
+
+  // Weight 1
+  bits_t x3 = s0 ^ s1, ones = x3 ^ s2, c3 = (s0 & s1) | (x3 & s2);
+  // Weight 2 (c0, c1, c2 and c3), carries have weight 4
+  bits_t x4 = c0 ^ c1, t = x4 ^ c2, c4 = (c0 & c1) | (x4 & c2);
+  bits_t twos = t ^ c3, c5 = t & c3;
+  // At least 4 neighbors
+  bits_t fours = c4 | c5;
+
+  // 3 neighbors, or 2 neighbors and alive
+  return ~fours & twos & (ones | me);
+}
+
+static int do_tile_bit (int x, int y, int width, int height, int who)
+{
+  const int w_end = min ((x + width + BITS - 1) / BITS, nb_words);
+  const int i_end = min (y + height, DIM - 1);
+  bits_t change   = 0;
+
+  monitoring_start_tile (who);
+
+  for (int i = max (y, 1); i < i_end; i++)
+    for (int w = x / BITS; w < w_end; w++) {
+      const bits_t *up = &cur_bits (i - 1, w), *me = &cur_bits (i, w),
+                   *down = &cur_bits (i + 1, w);
+
+      bits_t r = bits_rule ((up[0] << 1) | (up[-1] >> (BITS - 1)), up[0],
+                            (up[0] >> 1) | (up[1] << (BITS - 1)),
+                            (me[0] << 1) | (me[-1] >> (BITS - 1)), me[0],
+                            (me[0] >> 1) | (me[1] << (BITS - 1)),
+                            (down[0] << 1) | (down[-1] >> (BITS - 1)),
+                            down[0],
+                            (down[0] >> 1) | (down[1] << (BITS - 1)));
+
+      r &= col_mask[w];
+      next_bits (i, w) = r;
+      change |= r ^ me[0];
+    }
+
+  monitoring_end_tile (x, y, min (width, DIM - x), min (height, DIM - y),
+                       who);
+
+  const unsigned rows = min (height, DIM - y);
+
+  metrics_add (who, METRIC_CELLS, min (width, DIM - x) * rows);
+  metrics_add (who, METRIC_BYTES,
+               2 * (w_end - x / BITS) * rows * sizeof (bits_t));
+
+  return change != 0;
+}
+
+unsigned life_compute_bit (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += bit_tile_w)
+        change |= do_tile_bit (x, y, bit_tile_w, TILE_H, 0);
+
+    swap_bits ();
+
+    if (!change) { // we stop when all cells are stable
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
+unsigned life_compute_bit_omp (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = 0;
+
+#pragma omp parallel for collapse(2) schedule(runtime) reduction(| : change)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += bit_tile_w)
+        change |= do_tile_bit (x, y, bit_tile_w, TILE_H, omp_get_thread_num ());
+
+    swap_bits ();
+
+    if (!change) { // we stop when all cells are stable
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
+///////////////////////////// Hashlife version (hashlife)
+// The universe is an unbounded canonical quadtree: a node of level L is a
+// square of 2^L x 2^L cells made of 4 nodes of level L - 1, and leaves
+// (level 0) are single cells. Identical subtrees are shared, thanks to a hash
+// table indexed by the 4 children. The successor of a node (its centre,
+// 2^(L-1) cells wide, some generations later) is memoized in the node, so
+// that repetitive patterns are computed once.
+//
+// Each iteration advances 2^k generations, k being given by -ka (0 by
+// default). The window [0, DIM[ x [0, DIM[ of the universe is rendered into
+// cur_img, but patterns may grow well beyond it: unlike other variants, there
+// is no dead border. When the number of nodes exceeds a threshold, those
+// which are not reachable from the current universe are freed.
+// Suggested cmdline(s):
+// ./run -k life -v hashlife -s 6208 -a meta3x3 -ka 10 -r 1 -si
+//
+typedef struct hnode
+{
+  struct hnode *nw, *ne, *sw, *se; // children, NULL for leaves
+  struct hnode *result;            // memoized successor
+  struct hnode *next;              // hash chain, or free list
+  uint64_t population;
+  unsigned level;
+  unsigned marked;
+} hnode_t;
+
+#define HASH_MAX_LEVEL 62
+#define HASH_CHUNK 65536
+#define HASH_GC_THRESHOLD (1UL << 22)
+
+static hnode_t hash_dead = {.population = 0};
+static hnode_t hash_live = {.population = 1};
+
+static hnode_t *hash_root = NULL;
+static hnode_t *hash_empty[HASH_MAX_LEVEL + 1]; // empty node of each level
+static hnode_t **hash_buckets           = NULL;
+static unsigned long hash_mask          = 0;
+static unsigned long hash_nb_nodes      = 0;
+static unsigned long hash_gc_threshold  = HASH_GC_THRESHOLD;
+static hnode_t *hash_free               = NULL;
+static hnode_t **hash_chunks            = NULL;
+static unsigned hash_nb_chunks          = 0;
+static unsigned hash_step_log           = 0;
+static uint64_t hash_generation         = 0;
+
+static hnode_t *hash_alloc_node (void)
+{
+  if (hash_free == NULL) {
+    hnode_t *chunk = malloc (HASH_CHUNK * sizeof (hnode_t));
+
+    hash_chunks = realloc (hash_chunks, (hash_nb_chunks + 1) * sizeof (chunk));
+    if (chunk == NULL || hash_chunks == NULL)
+      exit_with_error ("Cannot allocate hashlife nodes (%lu in use)",
+                       hash_nb_nodes);
+    hash_chunks[hash_nb_chunks++] = chunk;
+
+    for (int i = HASH_CHUNK - 1; i >= 0; i--) {
+      chunk[i].next = hash_free;
+      hash_free     = chunk + i;
+    }
+  }
+
+  hnode_t *n = hash_free;
+  hash_free  = n->next;
+
+  return n;
+}
+
+static inline unsigned long hash_of (hnode_t *nw, hnode_t *ne, hnode_t *sw,
+                                     hnode_t *se)
+{
+  uint64_t h = (uintptr_t)nw;
+
+  h = h * 0x9E3779B97F4A7C15UL + (uintptr_t)ne;
+  h = h * 0x9E3779B97F4A7C15UL + (uintptr_t)sw;
+  h = h * 0x9E3779B97F4A7C15UL + (uintptr_t)se;
+
+  return h ^ (h >> 29);
+}
+
+static void hash_resize (unsigned long nb_buckets)
+{
+  hnode_t **old        = hash_buckets;
+  unsigned long old_nb = old ? hash_mask + 1 : 0;
+
+  hash_buckets = calloc (nb_buckets, sizeof (hnode_t *));
+  if (hash_buckets == NULL)
+    exit_with_error ("Cannot allocate hashlife table (%lu buckets)",
+                     nb_buckets);
+  hash_mask = nb_buckets - 1;
+
+  for (unsigned long b = 0; b < old_nb; b++)
+    for (hnode_t *n = old[b], *next; n != NULL; n = next) {
+      unsigned long h = hash_of (n->nw, n->ne, n->sw, n->se) & hash_mask;
+
+      next            = n->next;
+      n->next         = hash_buckets[h];
+      hash_buckets[h] = n;
+    }
+
+  free (old);
+}
+
+// Returns the canonical node made of the given children
+static hnode_t *hash_node (hnode_t *nw, hnode_t *ne, hnode_t *sw, hnode_t *se)
+{
+  unsigned long h = hash_of (nw, ne, sw, se) & hash_mask;
+  hnode_t *n;
+
+  for (n = hash_buckets[h]; n != NULL; n = n->next)
+    if (n->nw == nw && n->ne == ne && n->sw == sw && n->se == se)
+      return n;
+
+  n             = hash_alloc_node ();
+  n->nw         = nw;
+  n->ne         = ne;
+  n->sw         = sw;
+  n->se         = se;
+  n->result     = NULL;
+  n->population = nw->population + ne->population + sw->population +
+                  se->population;
+  n->level      = nw->level + 1;
+  n->marked     = 0;
+
+  n->next         = hash_buckets[h];
+  hash_buckets[h] = n;
+
+  if (++hash_nb_nodes > hash_mask + 1)
+    hash_resize (2 * (hash_mask + 1));
+
+  return n;
+}
+
+static hnode_t *hash_empty_node (unsigned level)
+{
+  if (hash_empty[level] == NULL) {
+    hnode_t *e = hash_empty_node (level - 1);
+
+    hash_empty[level] = hash_node (e, e, e, e);
+  }
+
+  return hash_empty[level];
+}
+
+// Top-left corner of the root, whose centre stays at (DIM / 2, DIM / 2)
+static inline int64_t hash_origin (void)
+{
+  return (int64_t)(DIM / 2) - ((int64_t)1 << (hash_root->level - 1));
+}
+
+// Doubles the size of the universe, keeping its centre
+static void hash_expand (void)
+{
+  hnode_t *n = hash_root;
+  hnode_t *e = hash_empty_node (n->level - 1);
+
+  if (n->level == HASH_MAX_LEVEL)
+    exit_with_error ("Hashlife universe cannot grow any further");
+
+  hash_root = hash_node (hash_node (e, e, e, n->nw), hash_node (e, e, n->ne, e),
+                         hash_node (e, n->sw, e, e), hash_node (n->se, e, e, e));
+}
+
+static hnode_t *hash_set (hnode_t *n, int64_t y, int64_t x)
+{
+  if (n->level == 0)
+    return &hash_live;
+
+  const int64_t half = (int64_t)1 << (n->level - 1);
+
+  if (y < half) {
+    if (x < half)
+      return hash_node (hash_set (n->nw, y, x), n->ne, n->sw, n->se);
+    return hash_node (n->nw, hash_set (n->ne, y, x - half), n->sw, n->se);
+  }
+  if (x < half)
+    return hash_node (n->nw, n->ne, hash_set (n->sw, y - half, x), n->se);
+  return hash_node (n->nw, n->ne, n->sw, hash_set (n->se, y - half, x - half));
+}
+
+static void hash_set_cell (int y, int x)
+{
+  while (y < hash_origin () || x < hash_origin () ||
+         y >= hash_origin () + ((int64_t)1 << hash_root->level) ||
+         x >= hash_origin () + ((int64_t)1 << hash_root->level))
+    hash_expand ();
+
+  hash_root = hash_set (hash_root, y - hash_origin (), x - hash_origin ());
+}
+
+static int hash_get_cell (int y, int x)
+{
+  hnode_t *n   = hash_root;
+  int64_t yy   = y - hash_origin (), xx = x - hash_origin ();
+  int64_t size = (int64_t)1 << n->level;
+
+  if (yy < 0 || xx < 0 || yy >= size || xx >= size)
+    return 0;
+
+  while (n->level > 0 && n->population > 0) {
+    const int64_t half = (int64_t)1 << (n->level - 1);
+
+    if (yy < half)
+      n = xx < half ? n->nw : n->ne;
+    else
+      n = xx < half ? n->sw : n->se;
+    yy &= half - 1;
+    xx &= half - 1;
+  }
+
+  return n == &hash_live;
+}
+
+void life_init_hashlife (void)
+{
+  if (hash_root == NULL) {
+    if (kernel_arg != NULL)
+      hash_step_log = atoi (kernel_arg);
+    if (hash_step_log > HASH_MAX_LEVEL - 3)
+      exit_with_error ("Hashlife step must be at most 2^%d (got 2^%s)",
+                       HASH_MAX_LEVEL - 3, kernel_arg);
+
+    PRINT_DEBUG ('u', "Hashlife: 2^%u generations per iteration\n",
+                 hash_step_log);
+
+    hash_resize (HASH_CHUNK);
+    hash_empty[0] = &hash_dead;
+    hash_root     = hash_empty_node (3);
+  }
+}
+
+void life_finalize_hashlife (void)
+{
+  PRINT_DEBUG ('u', "Hashlife: generation %lu, %lu nodes\n", hash_generation,
+               hash_nb_nodes);
+
+  for (int c = 0; c < hash_nb_chunks; c++)
+    free (hash_chunks[c]);
+  free (hash_chunks);
+  free (hash_buckets);
+}
+
+// Nothing to first-touch: nodes are allocated on demand
+void life_ft_hashlife (void)
+{
+}
+
+static void hash_render (hnode_t *n, int64_t y, int64_t x)
+{
+  const int64_t size = (int64_t)1 << n->level;
+
+  if (n->population == 0 || y >= DIM || x >= DIM || y + size <= 0 ||
+      x + size <= 0)
+    return;
+
+  if (n->level == 0) {
+    cur_img (y, x) = color;
+    return;
+  }
+
+  hash_render (n->nw, y, x);
+  hash_render (n->ne, y, x + size / 2);
+  hash_render (n->sw, y + size / 2, x);
+  hash_render (n->se, y + size / 2, x + size / 2);
+}
+
+void life_refresh_img_hashlife (void)
+{
+  memset (&cur_img (0, 0), 0, DIM * DIM * sizeof (unsigned));
+
+  hash_render (hash_root, hash_origin (), hash_origin ());
+}
+
+// Centre of n, one level below
+static inline hnode_t *hash_centre (hnode_t *n)
+{
+  return hash_node (n->nw->se, n->ne->sw, n->sw->ne, n->se->nw);
+}
+
+// Centre of two nodes of the same level, side by side
+static inline hnode_t *hash_centre_h (hnode_t *w, hnode_t *e)
+{
+  return hash_node (w->ne, e->nw, w->se, e->sw);
+}
+
+// Centre of two nodes of the same level, one above the other
+static inline hnode_t *hash_centre_v (hnode_t *n, hnode_t *s)
+{
+  return hash_node (n->sw, n->se, s->nw, s->ne);
+}
+
+// Centre of the centre of n, two levels below
+static inline hnode_t *hash_centre_centre (hnode_t *n)
+{
+  return hash_node (n->nw->se->se, n->ne->sw->sw, n->sw->ne->ne,
+                    n->se->nw->nw);
+}
+
+// One generation of the 2 x 2 centre of a 4 x 4 node
+static hnode_t *hash_base_case (hnode_t *n)
+{
+  hnode_t *q[4] = {n->nw, n->ne, n->sw, n->se};
+  unsigned cells = 0; // bit (y * 4 + x) is cell (y, x)
+  hnode_t *r[4];
+
+  for (int i = 0; i < 4; i++) {
+    const int y = (i >> 1) * 2, x = (i & 1) * 2;
+
+    cells |= (q[i]->nw == &hash_live) << (y * 4 + x);
+    cells |= (q[i]->ne == &hash_live) << (y * 4 + x + 1);
+    cells |= (q[i]->sw == &hash_live) << ((y + 1) * 4 + x);
+    cells |= (q[i]->se == &hash_live) << ((y + 1) * 4 + x + 1);
+  }
+
+  for (int i = 0; i < 4; i++) {
+    const int y = 1 + (i >> 1), x = 1 + (i & 1);
+    unsigned me = (cells >> (y * 4 + x)) & 1;
+    unsigned nb = 0;
+
+    for (int yy = y - 1; yy <= y + 1; yy++)
+      for (int xx = x - 1; xx <= x + 1; xx++)
+        nb += (cells >> (yy * 4 + xx)) & 1;
+
+    r[i] = ((nb == 3 + me) | (nb == 3)) ? &hash_live : &hash_dead;
+  }
+
+  return hash_node (r[0], r[1], r[2], r[3]);
+}
+
+// Returns the centre of n (level >= 2) after 2^min(level - 2, k) generations
+static hnode_t *hash_successor (hnode_t *n)
+{
+  if (n->result != NULL)
+    return n->result;
+
+  if (n->population == 0)
+    return n->result = n->nw;
+
+  if (n->level == 2)
+    return n->result = hash_base_case (n);
+
+  // 9 overlapping sub-nodes of level - 1
+  hnode_t *s[9] = {n->nw,
+                   hash_centre_h (n->nw, n->ne),
+                   n->ne,
+                   hash_centre_v (n->nw, n->sw),
+                   hash_centre (n),
+                   hash_centre_v (n->ne, n->se),
+                   n->sw,
+                   hash_centre_h (n->sw, n->se),
+                   n->se};
+
+  // Either advance them by half of the step, or just take their centre when
+  // the step is smaller than the node
+  for (int i = 0; i < 9; i++)
+    s[i] = (n->level - 2 <= hash_step_log) ? hash_successor (s[i])
+                                           : hash_centre (s[i]);
+
+  return n->result = hash_node (
+             hash_successor (hash_node (s[0], s[1], s[3], s[4])),
+             hash_successor (hash_node (s[1], s[2], s[4], s[5])),
+             hash_successor (hash_node (s[3], s[4], s[6], s[7])),
+             hash_successor (hash_node (s[4], s[5], s[7], s[8])));
+}
+
+static void hash_mark (hnode_t *n)
+{
+  if (n->level == 0 || n->marked)
+    return;
+
+  n->marked = 1;
+  hash_mark (n->nw);
+  hash_mark (n->ne);
+  hash_mark (n->sw);
+  hash_mark (n->se);
+}
+
+// Frees the nodes which are not part of the current universe. Memoized
+// results are kept as long as they survive.
+static void hash_gc (void)
+{
+  unsigned long before = hash_nb_nodes;
+
+  hash_mark (hash_root);
+  for (int l = 1; l <= HASH_MAX_LEVEL && hash_empty[l] != NULL; l++)
+    hash_mark (hash_empty[l]);
+
+  for (unsigned long b = 0; b <= hash_mask; b++)
+    for (hnode_t **p = hash_buckets + b; *p != NULL;) {
+      hnode_t *n = *p;
+
+      if (n->marked) {
+        if (n->result != NULL && !n->result->marked)
+          n->result = NULL;
+        p = &n->next;
+      } else {
+        *p        = n->next;
+        n->next   = hash_free;
+        hash_free = n;
+        hash_nb_nodes--;
+      }
+    }
+
+  for (unsigned long b = 0; b <= hash_mask; b++)
+    for (hnode_t *n = hash_buckets[b]; n != NULL; n = n->next)
+      n->marked = 0;
+
+  PRINT_DEBUG ('u', "Hashlife: %lu nodes freed, %lu left\n",
+               before - hash_nb_nodes, hash_nb_nodes);
+}
+
+// Returns 1 if the universe changed
+static int hash_step (void)
+{
+  // The pattern must fit in the centre of the centre, so that it cannot
+  // escape from the centre (i.e. the result) during a step
+  while (hash_root->level < hash_step_log + 3 ||
+         hash_centre_centre (hash_root)->population !=
+             hash_root->population)
+    hash_expand ();
+
+  hnode_t *before = hash_centre (hash_root);
+
+  hash_root = hash_successor (hash_root);
+  hash_generation += (uint64_t)1 << hash_step_log;
+
+  return hash_root != before;
+}
+
+unsigned life_compute_hashlife (unsigned nb_iter)
+{
+  unsigned res = 0;
+
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change;
+
+    if (hash_nb_nodes > hash_gc_threshold) {
+      hash_gc ();
+      if (hash_nb_nodes > hash_gc_threshold / 2)
+        hash_gc_threshold *= 2;
+    }
+
+    monitoring_start_tile (0);
+
+    change = hash_step ();
+
+    monitoring_end_tile (0, 0, DIM, DIM, 0);
+
+    if (!change) { // we stop when all cells are stable
+      res = it;
+      break;
+    }
+  }
+
+  return res;
+}
+
 ///////////////////////////// Initial configs
 
 void life_draw_guns (void);
 
 static inline void set_cell (int y, int x)
 {
-  cur_table (y, x) = 1;
+  if (hash_root != NULL)
+    hash_set_cell (y, x);
+  else if (_bits != NULL)
+    cur_bits (y, x / BITS) |= (bits_t)1 << (x % BITS);
+  else
+    cur_table (y, x) = 1;
   if (opencl_used)
     cur_img (y, x) = 1;
 }
 
 static inline int get_cell (int y, int x)
 {
+  if (hash_root != NULL)
+    return hash_get_cell (y, x);
+  if (_bits != NULL)
+    return (cur_bits (y, x / BITS) >> (x % BITS)) & 1;
   return cur_table (y, x);
 }
 
+// Address of cell (y, 0), for the streaming RLE loader and generator
+static void *life_rle_row (int y)
+{
+  if (_bits != NULL)
+    return &cur_bits (y, 0);
+  return &cur_table (y, 0);
+}
+
 static void inline life_rle_parse (char *filename, int x, int y,
                                    int orientation)
 {
-  rle_lexer_parse (filename, x, y, set_cell, orientation);
+  // Cells must go through set_cell when they are not simply stored in a
+  // table
+  if (hash_root != NULL || opencl_used)
+    rle_lexer_parse (filename, x, y, set_cell, orientation);
+  else
+    rle_stream_parse (filename, x, y, orientation,
+                      _bits != NULL ? RLE_LAYOUT_BITS : RLE_LAYOUT_CELLS,
+                      life_rle_row);
 }
 
 static void inline life_rle_generate (char *filename, int x, int y, int width,
                                       int height)
 {
-  rle_generate (x, y, width, height, get_cell, filename);
+  if (hash_root != NULL)
+    rle_generate (x, y, width, height, get_cell, filename);
+  else
+    rle_stream_generate (x, y, width, height,
+                         _bits != NULL ? RLE_LAYOUT_BITS : RLE_LAYOUT_CELLS,
+                         life_rle_row, filename);
 }
 
 void life_draw (char *param)
@@ -21,6 +21,18 @@ void max_init (void)
   monitoring_declare_task_ids (task_ids);
 }
 
+// Used with --first-touch: each tile is touched by the thread which computes
+// it when tiles are distributed by a static OpenMP schedule
+void max_ft (void)
+{
+#pragma omp parallel for collapse(2) schedule(runtime)
+  for (int y = 0; y < DIM; y += TILE_H)
+    for (int x = 0; x < DIM; x += TILE_W)
+      for (int i = y; i < y + TILE_H; i++)
+        for (int j = x; j < x + TILE_W; j++)
+          cur_img (i, j) = next_img (i, j) = 0;
+}
+
 // We propagate the max color down-right. This is the expensive implementation
 // which constantly checks border conditions...
 int tile_down_right (int x, int y, int w, int h, int cpu)
@@ -141,6 +153,40 @@ unsigned max_compute_tiled (unsigned nb_iter)
 }
 
 
+///////////////////////////// Pthread version (pthread)
+// Each propagation step goes through all tiles in parallel on the workers of
+// src/scheduler.c, according to OMP_SCHEDULE. Tiles read the borders of
+// their neighbors while these are updated, but colors can only increase, so
+// the computation still converges to the same image.
+// Suggested cmdline(s):
+// OMP_SCHEDULE=dynamic ./run -l images/spirale.png -k max -v pthread -ts 32
+//
+void max_init_pthread (void)
+{
+  max_init ();
+  scheduler_init (-1);
+}
+
+void max_finalize_pthread (void)
+{
+  scheduler_finalize ();
+}
+
+unsigned max_compute_pthread (unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++) {
+    int change = scheduler_parallel_for_tiles (tile_down_right, REDUCTION_OR);
+
+    change |= scheduler_parallel_for_tiles (tile_up_left, REDUCTION_OR);
+
+    if (!change)
+      return it;
+  }
+
+  return 0;
+}
+
+
 ///////////////////////////// Drawing functions
 
 static void spiral (unsigned twists);
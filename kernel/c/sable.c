@@ -1,14 +1,28 @@
 #include "easypap.h"
 
 #include <omp.h>
+#include <sched.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
+#ifdef ENABLE_VECTO
+#include <immintrin.h>
+#endif
+
 typedef unsigned TYPE;
 
 static TYPE *TABLE = NULL;
 static TYPE *STABILITY_TABLE = NULL;
+static TYPE *ALT_TABLE = NULL;
+
+// When the table is split across MPI processes (see mpi_omp), a process only
+// holds rows [band_lo, band_hi[, plus one halo row on each side. TABLE and
+// ALT_TABLE then start at row table_row0.
+static bool band_mode = false;
+static int band_lo, band_hi;
+static long table_row0 = 0;
 
 static volatile int changement;
 
@@ -16,7 +30,15 @@ static TYPE max_grains;
 
 static inline TYPE *table_cell(TYPE *restrict i, int y, int x)
 {
-  return i + y * DIM + x;
+  return i + (size_t)(y - table_row0) * DIM + x;
+}
+
+// Size of TABLE and ALT_TABLE
+static size_t table_size(void)
+{
+  const size_t rows = band_mode ? band_hi - band_lo + 2 : DIM;
+
+  return rows * DIM * sizeof(TYPE);
 }
 
 static inline TYPE *stable_table_cell(TYPE *restrict i, int y, int x)
@@ -27,10 +49,196 @@ static inline TYPE *stable_table_cell(TYPE *restrict i, int y, int x)
 #define TILE_SIZE TILE_W *TILE_H
 
 #define table(y, x) (*table_cell(TABLE, (y), (x)))
+#define alt_table(y, x) (*table_cell(ALT_TABLE, (y), (x)))
 #define not_stable(y, x) (*stable_table_cell(STABILITY_TABLE, (y), (x)))
 
 #define RGB(r, g, b) rgba(r, g, b, 0xFF)
 
+////////////////////// Stockage compact ////////////////////////
+// In compact mode (compact variants), cells are stored on one byte in
+// CTABLE. Cells holding OVERFLOW_MARK or more grains are escaped: their
+// actual value lives in a small open-addressing hash table indexed by cell
+// offset. Border cells are sinks, their grains are simply dropped.
+
+typedef uint8_t CTYPE;
+
+#define OVERFLOW_MARK 255
+#define OVERFLOW_EMPTY UINT32_MAX
+
+static CTYPE *CTABLE = NULL;
+static bool compact_mode = false;
+
+struct overflow_cell
+{
+  uint32_t index;
+  TYPE grains;
+};
+
+static struct overflow_cell *overflow = NULL;
+static unsigned overflow_capacity = 0; // always a power of two
+static unsigned overflow_count = 0;
+
+#define ctable(y, x) (CTABLE[(y)*DIM + (x)])
+
+static inline unsigned overflow_hash(uint32_t index)
+{
+  return (index * 2654435761U) & (overflow_capacity - 1);
+}
+
+static struct overflow_cell *overflow_find(uint32_t index)
+{
+  unsigned h = overflow_hash(index);
+
+  while (overflow[h].index != index)
+    h = (h + 1) & (overflow_capacity - 1);
+
+  return &overflow[h];
+}
+
+static void overflow_insert(uint32_t index, TYPE grains);
+
+static void overflow_resize(unsigned capacity)
+{
+  struct overflow_cell *old = overflow;
+  unsigned old_capacity = overflow_capacity;
+
+  overflow = malloc(capacity * sizeof(struct overflow_cell));
+  memset(overflow, 0xFF, capacity * sizeof(struct overflow_cell));
+  overflow_capacity = capacity;
+  overflow_count = 0;
+
+  for (unsigned h = 0; h < old_capacity; h++)
+    if (old[h].index != OVERFLOW_EMPTY)
+      overflow_insert(old[h].index, old[h].grains);
+
+  free(old);
+}
+
+static void overflow_insert(uint32_t index, TYPE grains)
+{
+  if (2 * (overflow_count + 1) > overflow_capacity)
+    overflow_resize(2 * overflow_capacity);
+
+  unsigned h = overflow_hash(index);
+
+  while (overflow[h].index != OVERFLOW_EMPTY)
+    h = (h + 1) & (overflow_capacity - 1);
+
+  overflow[h].index = index;
+  overflow[h].grains = grains;
+  overflow_count++;
+}
+
+// Backward shift deletion, so that lookups never need tombstones
+static void overflow_remove(uint32_t index)
+{
+  struct overflow_cell *c = overflow_find(index);
+  unsigned hole = c - overflow;
+  unsigned h = hole;
+
+  for (;;)
+  {
+    h = (h + 1) & (overflow_capacity - 1);
+    if (overflow[h].index == OVERFLOW_EMPTY)
+      break;
+
+    unsigned home = overflow_hash(overflow[h].index);
+    // Move the entry back if its home slot is not in ]hole, h]
+    if (((h - home) & (overflow_capacity - 1)) >=
+        ((h - hole) & (overflow_capacity - 1)))
+    {
+      overflow[hole] = overflow[h];
+      hole = h;
+    }
+  }
+
+  overflow[hole].index = OVERFLOW_EMPTY;
+  overflow_count--;
+}
+
+static inline bool is_border(int y, int x)
+{
+  return y == 0 || x == 0 || y == DIM - 1 || x == DIM - 1;
+}
+
+static inline TYPE compact_get(int y, int x)
+{
+  CTYPE c = ctable(y, x);
+
+  if (c != OVERFLOW_MARK)
+    return c;
+
+  TYPE g;
+#pragma omp critical(sable_overflow)
+  g = overflow_find(y * DIM + x)->grains;
+  return g;
+}
+
+static inline void compact_set(int y, int x, TYPE v)
+{
+  CTYPE c = ctable(y, x);
+
+  if (c != OVERFLOW_MARK && v < OVERFLOW_MARK)
+  {
+    ctable(y, x) = v;
+    return;
+  }
+
+#pragma omp critical(sable_overflow)
+  {
+    if (c == OVERFLOW_MARK && v < OVERFLOW_MARK)
+    {
+      overflow_remove(y * DIM + x);
+      ctable(y, x) = v;
+    }
+    else if (c == OVERFLOW_MARK)
+      overflow_find(y * DIM + x)->grains = v;
+    else if (!is_border(y, x))
+    {
+      overflow_insert(y * DIM + x, v);
+      ctable(y, x) = OVERFLOW_MARK;
+    }
+  }
+}
+
+static inline void compact_add(int y, int x, TYPE d)
+{
+  CTYPE c = ctable(y, x);
+
+  if (c + d < OVERFLOW_MARK)
+    ctable(y, x) = c + d;
+  else if (c == OVERFLOW_MARK)
+  {
+#pragma omp critical(sable_overflow)
+    overflow_find(y * DIM + x)->grains += d;
+  }
+  else
+    compact_set(y, x, c + d);
+}
+
+// Storage-independent accessors, used outside of compute kernels
+static inline TYPE get_grains(int y, int x)
+{
+  return compact_mode ? compact_get(y, x) : table(y, x);
+}
+
+static inline void set_grains(int y, int x, TYPE v)
+{
+  if (compact_mode)
+    compact_set(y, x, v);
+  else
+    table(y, x) = v;
+}
+
+static inline void draw_grains(int y, int x, TYPE v)
+{
+  if (band_mode && (y < band_lo || y >= band_hi))
+    return;
+
+  cur_img(y, x) = v;
+  set_grains(y, x, v);
+}
+
 ////////////////////// DEBUG ////////////////////////
 void print_debug(TYPE *t, int nth, int ntw)
 {
@@ -49,39 +257,107 @@ void sable_init()
 {
   if (TABLE == NULL)
   {
-    const unsigned size = DIM * DIM * sizeof(TYPE);
-    const unsigned stability_size = (DIM / TILE_H) * (DIM / TILE_W) * sizeof(TYPE);
+    const size_t size = table_size();
+    const size_t stability_size =
+        (size_t)(DIM / TILE_H) * (DIM / TILE_W) * sizeof(TYPE);
 
-    PRINT_DEBUG('u', "Memory footprint = 2 x %d bytes\n", size);
+    PRINT_DEBUG('u', "Memory footprint = %zu bytes\n", size);
 
     TABLE = mmap(NULL, size, PROT_READ | PROT_WRITE,
                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (TABLE == MAP_FAILED)
+      exit_with_error("Cannot allocate %zu bytes for the table", size);
 
-    STABILITY_TABLE = mmap(NULL, stability_size, PROT_READ | PROT_WRITE,
-                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    mem_policy_apply(TABLE, size);
+    mem_policy_register("TABLE", TABLE, size);
 
-    for (int y = 0; y < DIM; y += TILE_H)
-      for (int x = 0; x < DIM; x += TILE_W)
-        not_stable(y / TILE_H, x / TILE_W) = 1;
+    // Bands (mpi_omp) do not track the stability of tiles
+    if (!band_mode)
+    {
+      STABILITY_TABLE = mmap(NULL, stability_size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+      mem_policy_apply(STABILITY_TABLE, stability_size);
+      mem_policy_register("STABILITY_TABLE", STABILITY_TABLE, stability_size);
+
+      for (int y = 0; y < DIM; y += TILE_H)
+        for (int x = 0; x < DIM; x += TILE_W)
+          not_stable(y / TILE_H, x / TILE_W) = 1;
+    }
   }
 }
 void sable_finalize()
 {
-  const unsigned size = DIM * DIM * sizeof(TYPE);
-  const unsigned stability_size = (DIM / TILE_H) * (DIM / TILE_W) * sizeof(TYPE);
+  const size_t stability_size =
+      (size_t)(DIM / TILE_H) * (DIM / TILE_W) * sizeof(TYPE);
+
+  munmap(TABLE, table_size());
+  if (STABILITY_TABLE != NULL)
+    munmap(STABILITY_TABLE, stability_size);
+}
+
+///////////////////////////// Premier contact (first touch)
+// Used with --first-touch: pages land on the NUMA node of the thread which
+// touches them first, so each tile is touched by the thread which computes
+// it under OMP_SCHEDULE=static. sable_ft follows the checkerboard of the
+// tiled OMP variants, sable_ft_sync_omp sweeps all tiles at once.
+
+static void touch_tile(int x, int y)
+{
+  for (int i = y; i < y + TILE_H; i++)
+    for (int j = x; j < x + TILE_W; j++)
+    {
+      cur_img(i, j) = 0;
+      if (TABLE != NULL)
+        table(i, j) = 0;
+      if (ALT_TABLE != NULL)
+        alt_table(i, j) = 0;
+      if (CTABLE != NULL)
+        ctable(i, j) = 0;
+    }
+}
+
+void sable_ft(void)
+{
+#pragma omp parallel
+  for (int phase = 0; phase < 4; phase++)
+  {
+    const int oy = (phase == 1 || phase == 3) * TILE_H;
+    const int ox = (phase == 1 || phase == 2) * TILE_W;
+
+#pragma omp for collapse(2) schedule(runtime)
+    for (int y = oy; y < DIM; y += 2 * TILE_H)
+      for (int x = ox; x < DIM; x += 2 * TILE_W)
+        touch_tile(x, y);
+  }
+}
+
+void sable_ft_sync_omp(void)
+{
+#pragma omp parallel for collapse(2) schedule(runtime)
+  for (int y = 0; y < DIM; y += TILE_H)
+    for (int x = 0; x < DIM; x += TILE_W)
+      touch_tile(x, y);
+}
+
+void sable_ft_sync_omp_vec(void)
+{
+  sable_ft_sync_omp();
+}
 
-  munmap(TABLE, size);
-  munmap(STABILITY_TABLE, stability_size);
+void sable_ft_tblock_omp(void)
+{
+  sable_ft_sync_omp();
 }
 
 ///////////////////////////// Production d'une image
-void sable_refresh_img()
+static unsigned long int refresh_rows(int lo, int hi)
 {
   unsigned long int max = 0;
-  for (int i = 1; i < DIM - 1; i++)
+  for (int i = lo; i < hi; i++)
     for (int j = 1; j < DIM - 1; j++)
     {
-      int g = table(i, j);
+      int g = get_grains(i, j);
       int r, v, b;
       r = v = b = 0;
       if (g == 1)
@@ -99,12 +375,19 @@ void sable_refresh_img()
       if (g > max)
         max = g;
     }
-  max_grains = max;
+  return max;
+}
+
+void sable_refresh_img()
+{
+  max_grains = refresh_rows(1, DIM - 1);
 }
 
 ///////////////////////////// Version séquentielle simple (seq)
 
-static inline int compute_new_state(int y, int x)
+// Returns the number of topplings of cell (y, x), which is nonzero iff the
+// cell changed
+static inline unsigned compute_new_state(int y, int x)
 {
   if (table(y, x) >= 4)
   {
@@ -114,14 +397,22 @@ static inline int compute_new_state(int y, int x)
     table(y - 1, x) += div4;
     table(y + 1, x) += div4;
     table(y, x) %= 4;
-    return 1;
+    return div4;
   }
   return 0;
 }
 
+// At most one read and one write per cell, in place
+static inline void tile_metrics(int who, unsigned cells, uint64_t topples)
+{
+  metrics_add(who, METRIC_CELLS, cells);
+  metrics_add(who, METRIC_TOPPLES, topples);
+  metrics_add(who, METRIC_BYTES, 2 * (uint64_t)cells * sizeof(TYPE));
+}
+
 static int do_tile(int x, int y, int width, int height, int who)
 {
-  int chgt = 0;
+  uint64_t topples = 0;
   PRINT_DEBUG('c', "tuile [%d-%d][%d-%d] traitée\n", x, x + width - 1, y,
               y + height - 1);
 
@@ -130,15 +421,18 @@ static int do_tile(int x, int y, int width, int height, int who)
   for (int i = y; i < y + height; i++)
     for (int j = x; j < x + width; j++)
     {
-      chgt |= compute_new_state(i, j);
+      topples += compute_new_state(i, j);
     }
 
   monitoring_end_tile(x, y, width, height, who);
-  return chgt;
+
+  tile_metrics(who, width * height, topples);
+
+  return topples != 0;
 }
 static int do_double_tile(int x, int y, int width, int height, int who)
 {
-  int chgt = 0;
+  uint64_t topples = 0;
   PRINT_DEBUG('c', "tuile [%d-%d][%d-%d] traitée\n", x, x + width - 1, y,
               y + height - 1);
 
@@ -147,24 +441,26 @@ static int do_double_tile(int x, int y, int width, int height, int who)
   for (int i = y; i < y + height; i++)
     for (int j = x; j < x + width; j++)
     {
-      chgt |= compute_new_state(i, j);
+      topples += compute_new_state(i, j);
     }
-  if (chgt == 0)
+  if (topples == 0)
   {
     monitoring_end_tile(x, y, width, height, who);
+    tile_metrics(who, width * height, 0);
     return 0;
   }
   for (int i = y; i < y + height; i++)
     for (int j = x; j < x + width; j++)
     {
-      chgt |= compute_new_state(i, j);
+      topples += compute_new_state(i, j);
     }
   monitoring_end_tile(x, y, width, height, who);
-  return chgt;
+  tile_metrics(who, 2 * width * height, topples);
+  return 1;
 }
 static int do_tile_stable(int x, int y, int width, int height, int who)
 {
-  int change = 0;
+  uint64_t change = 0;
   monitoring_start_tile(who);
   for (int i = y; i < y + height; i++)
   {
@@ -176,6 +472,8 @@ static int do_tile_stable(int x, int y, int width, int height, int who)
     change += compute_new_state(y, j);
     change += compute_new_state(y + height - 1, j);
   }
+  // Only the border of the tile was computed
+  tile_metrics(who, 2 * (width + height), change);
   monitoring_end_tile(x, y, width, height, who);
   if (change == 0)
   {
@@ -185,7 +483,7 @@ static int do_tile_stable(int x, int y, int width, int height, int who)
 }
 static int do_tile_unstable(int x, int y, int width, int height, int who)
 {
-  int change = 0;
+  uint64_t change = 0;
   PRINT_DEBUG('c', "tuile [%d-%d][%d-%d] traitée\n", x, x + width - 1, y,
               y + height - 1);
 
@@ -199,6 +497,7 @@ static int do_tile_unstable(int x, int y, int width, int height, int who)
     }
   }
   monitoring_end_tile(x, y, width, height, who);
+  tile_metrics(who, width * height, change);
   if (!change)
   {
     return 0;
@@ -207,7 +506,7 @@ static int do_tile_unstable(int x, int y, int width, int height, int who)
 }
 static int do_double_tile_stable(int x, int y, int width, int height, int who)
 {
-  int change = 0;
+  uint64_t change = 0;
   monitoring_start_tile(who);
   for (int i = y; i < y + height; i++)
   {
@@ -219,6 +518,8 @@ static int do_double_tile_stable(int x, int y, int width, int height, int who)
     change += compute_new_state(y, j);
     change += compute_new_state(y + height - 1, j);
   }
+  // Only the border of the tile was computed
+  tile_metrics(who, 2 * (width + height), change);
   if (change == 0)
   {
     monitoring_end_tile(x, y, width, height, who);
@@ -232,7 +533,7 @@ static int do_double_tile_stable(int x, int y, int width, int height, int who)
 }
 static int do_double_tile_unstable(int x, int y, int width, int height, int who)
 {
-  int change = 0;
+  uint64_t change = 0;
   PRINT_DEBUG('c', "tuile [%d-%d][%d-%d] traitée\n", x, x + width - 1, y,
               y + height - 1);
 
@@ -248,6 +549,7 @@ static int do_double_tile_unstable(int x, int y, int width, int height, int who)
   if (!change)
   {
     monitoring_end_tile(x, y, width, height, who);
+    tile_metrics(who, width * height, 0);
     return 0;
   }
 
@@ -259,6 +561,7 @@ static int do_double_tile_unstable(int x, int y, int width, int height, int who)
     }
   }
   monitoring_end_tile(x, y, width, height, who);
+  tile_metrics(who, 2 * width * height, change);
   if (!change)
   {
     return 0;
@@ -344,6 +647,8 @@ unsigned sable_compute_tiled_stable(unsigned nb_iter)
                                                               TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                               omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -379,6 +684,8 @@ unsigned sable_compute_double_tiled_stable(unsigned nb_iter)
                                                                      TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                                      omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -388,7 +695,51 @@ unsigned sable_compute_double_tiled_stable(unsigned nb_iter)
   return 0;
 }
 
-////////////////////////////// Version OMP
+////////////////////////////// Version pthread (pthread)
+// Same checkerboard as tiled_omp, on the worker pool of src/scheduler.c.
+// Tiles are distributed according to OMP_SCHEDULE, as with schedule(runtime).
+//
+// Suggested cmdline:
+// OMP_SCHEDULE=dynamic,2 ./run -k sable -v pthread -s 2048 -ts 32 -n
+
+void sable_init_pthread(void)
+{
+  sable_init();
+  scheduler_init(-1);
+}
+
+void sable_finalize_pthread(void)
+{
+  scheduler_finalize();
+  sable_finalize();
+}
+
+static int do_tile_trimmed(int x, int y, int width, int height, int who)
+{
+  return do_tile(x + (x == 0), y + (y == 0),
+                 width - ((x + width == DIM) + (x == 0)),
+                 height - ((y + height == DIM) + (y == 0)), who);
+}
+
+unsigned sable_compute_pthread(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    changement = 0;
+
+    for (int phase = 0; phase < 4; phase++)
+      changement |= scheduler_parallel_for_tile_subset(
+          do_tile_trimmed, REDUCTION_OR, (phase == 1 || phase == 2),
+          (phase == 1 || phase == 3), 2);
+
+    if (changement == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version OMP
 unsigned sable_compute_tiled_omp(unsigned nb_iter) //tile size perfect is 32
 {
   for (unsigned it = 1; it <= nb_iter; it++)
@@ -513,6 +864,8 @@ unsigned sable_compute_tiled_stable_omp(unsigned nb_iter)
                                                               TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                               omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -539,6 +892,8 @@ unsigned sable_compute_tiled_stable_omp(unsigned nb_iter)
                                                               TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                               omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -565,6 +920,8 @@ unsigned sable_compute_tiled_stable_omp(unsigned nb_iter)
                                                               TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                               omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -591,6 +948,8 @@ unsigned sable_compute_tiled_stable_omp(unsigned nb_iter)
                                                               TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                               omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -628,6 +987,8 @@ unsigned sable_compute_double_tiled_stable_omp(unsigned nb_iter)
                                                                      TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                                      omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -654,6 +1015,8 @@ unsigned sable_compute_double_tiled_stable_omp(unsigned nb_iter)
                                                                      TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                                      omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -680,6 +1043,8 @@ unsigned sable_compute_double_tiled_stable_omp(unsigned nb_iter)
                                                                      TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                                      omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -706,6 +1071,8 @@ unsigned sable_compute_double_tiled_stable_omp(unsigned nb_iter)
                                                                      TILE_H - ((i + TILE_H == DIM) + (i == 0)),
                                                                      omp_get_thread_num());
         }
+        else
+          metrics_add(omp_get_thread_num(), METRIC_SKIPPED, 1);
         changement += not_stable(i / TILE_H, j / TILE_W);
       }
     }
@@ -715,6 +1082,1558 @@ unsigned sable_compute_double_tiled_stable_omp(unsigned nb_iter)
   return 0;
 }
 
+///////////////////////////// Version frontière (frontier)
+// Only the tiles dirtied by the previous sweep are visited, so the cost of an
+// iteration depends on the active area instead of DIM².
+// Tiles are bucketed by the parity of their coordinates so that the OMP
+// variant can process each bucket in parallel, like the checkerboard above.
+
+#define NB_PHASES 4
+
+static unsigned *frontier[NB_PHASES], *next_frontier[NB_PHASES];
+static unsigned frontier_size[NB_PHASES], next_frontier_size[NB_PHASES];
+static char *in_next_frontier = NULL;
+
+static inline int tile_phase(int ty, int tx)
+{
+  // Same phase order as sable_compute_tiled_omp
+  static const int phase[2][2] = {{0, 2}, {3, 1}};
+  return phase[ty & 1][tx & 1];
+}
+
+static inline void frontier_push(int ty, int tx)
+{
+  if (ty < 0 || ty >= NB_TILES_Y || tx < 0 || tx >= NB_TILES_X)
+    return;
+
+  unsigned t = ty * NB_TILES_X + tx;
+  if (__atomic_load_n(&in_next_frontier[t], __ATOMIC_RELAXED) ||
+      __atomic_exchange_n(&in_next_frontier[t], 1, __ATOMIC_RELAXED))
+    return;
+
+  int p = tile_phase(ty, tx);
+  next_frontier[p][__atomic_fetch_add(&next_frontier_size[p], 1, __ATOMIC_RELAXED)] = t;
+}
+
+static inline void frontier_swap(void)
+{
+  for (int p = 0; p < NB_PHASES; p++)
+  {
+    unsigned *tmp = frontier[p];
+    frontier[p] = next_frontier[p];
+    next_frontier[p] = tmp;
+    frontier_size[p] = next_frontier_size[p];
+    next_frontier_size[p] = 0;
+
+    for (unsigned k = 0; k < frontier_size[p]; k++)
+      in_next_frontier[frontier[p][k]] = 0;
+  }
+}
+
+static inline unsigned frontier_total(void)
+{
+  unsigned n = 0;
+  for (int p = 0; p < NB_PHASES; p++)
+    n += frontier_size[p];
+  return n;
+}
+
+static void do_frontier_tile(unsigned t, int who)
+{
+  int ty = t / NB_TILES_X;
+  int tx = t % NB_TILES_X;
+  int y = ty * TILE_H;
+  int x = tx * TILE_W;
+
+  if (do_tile_unstable(x + (x == 0), y + (y == 0),
+                       TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                       TILE_H - ((y + TILE_H == DIM) + (y == 0)), who))
+  {
+    // Toppled grains may have crossed the tile borders
+    frontier_push(ty, tx);
+    frontier_push(ty - 1, tx);
+    frontier_push(ty + 1, tx);
+    frontier_push(ty, tx - 1);
+    frontier_push(ty, tx + 1);
+  }
+}
+
+void sable_init_frontier(void)
+{
+  sable_init();
+
+  if (in_next_frontier == NULL)
+  {
+    const unsigned nb_tiles = NB_TILES_X * NB_TILES_Y;
+
+    in_next_frontier = calloc(nb_tiles, sizeof(char));
+    for (int p = 0; p < NB_PHASES; p++)
+    {
+      frontier[p] = malloc(nb_tiles * sizeof(unsigned));
+      next_frontier[p] = malloc(nb_tiles * sizeof(unsigned));
+      next_frontier_size[p] = 0;
+    }
+
+    // Every tile is potentially unstable at startup
+    for (int ty = 0; ty < NB_TILES_Y; ty++)
+      for (int tx = 0; tx < NB_TILES_X; tx++)
+        frontier_push(ty, tx);
+    frontier_swap();
+  }
+}
+
+void sable_init_frontier_omp(void)
+{
+  sable_init_frontier();
+}
+
+void sable_finalize_frontier(void)
+{
+  for (int p = 0; p < NB_PHASES; p++)
+  {
+    free(frontier[p]);
+    free(next_frontier[p]);
+  }
+  free(in_next_frontier);
+
+  sable_finalize();
+}
+
+void sable_finalize_frontier_omp(void)
+{
+  sable_finalize_frontier();
+}
+
+unsigned sable_compute_frontier(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    metrics_add(0, METRIC_SKIPPED, NB_TILES_X * NB_TILES_Y - frontier_total());
+
+    for (int p = 0; p < NB_PHASES; p++)
+      for (unsigned k = 0; k < frontier_size[p]; k++)
+        do_frontier_tile(frontier[p][k], 0 /* CPU id */);
+
+    frontier_swap();
+
+    if (frontier_total() == 0)
+      return it;
+  }
+  return 0;
+}
+
+unsigned sable_compute_frontier_omp(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    metrics_add(0, METRIC_SKIPPED, NB_TILES_X * NB_TILES_Y - frontier_total());
+
+#pragma omp parallel
+    for (int p = 0; p < NB_PHASES; p++)
+    {
+      // Tiles of the same phase never share a border, implicit barrier between
+      // phases
+#pragma omp for schedule(runtime)
+      for (unsigned k = 0; k < frontier_size[p]; k++)
+        do_frontier_tile(frontier[p][k], omp_get_thread_num());
+    }
+
+    frontier_swap();
+
+    if (frontier_total() == 0)
+      return it;
+  }
+  return 0;
+}
+
+///////////////////////////// Version vectorisée (tiled_vec)
+// Each tile row is toppled in SIMD lanes: all cells of the row give away
+// their grains at once, then receive those of their left/right neighbors.
+// Toppling order does not matter for the abelian sandpile, so the final
+// configuration is the same as seq.
+
+#ifdef ENABLE_VECTO
+
+#if AVX2 == 1
+typedef __m256i vec_int_t;
+#define vec_load(p) _mm256_loadu_si256((vec_int_t *)(p))
+#define vec_store(p, v) _mm256_storeu_si256((vec_int_t *)(p), (v))
+#define vec_add(a, b) _mm256_add_epi32((a), (b))
+#define vec_or(a, b) _mm256_or_si256((a), (b))
+#define vec_and(a, b) _mm256_and_si256((a), (b))
+#define vec_xor(a, b) _mm256_xor_si256((a), (b))
+#define vec_srli(a, n) _mm256_srli_epi32((a), (n))
+#define vec_set1(n) _mm256_set1_epi32(n)
+#define vec_is_zero(a) _mm256_testz_si256((a), (a))
+#elif SSE == 1
+typedef __m128i vec_int_t;
+#define vec_load(p) _mm_loadu_si128((vec_int_t *)(p))
+#define vec_store(p, v) _mm_storeu_si128((vec_int_t *)(p), (v))
+#define vec_add(a, b) _mm_add_epi32((a), (b))
+#define vec_or(a, b) _mm_or_si128((a), (b))
+#define vec_and(a, b) _mm_and_si128((a), (b))
+#define vec_xor(a, b) _mm_xor_si128((a), (b))
+#define vec_srli(a, n) _mm_srli_epi32((a), (n))
+#define vec_set1(n) _mm_set1_epi32(n)
+#define vec_is_zero(a) \
+  (_mm_movemask_epi8(_mm_cmpeq_epi32((a), _mm_setzero_si128())) == 0xFFFF)
+#endif
+
+static int do_tile_vec(int x, int y, int width, int height, int who)
+{
+  // div4[k] holds the grains given by cell x + k - 1 to each neighbor
+  TYPE div4[width + 2];
+  TYPE change = 0;
+  uint64_t topples = 0;
+  vec_int_t vchange = vec_set1(0);
+  const vec_int_t three = vec_set1(3);
+  const int vec_end = x + width - (width % VEC_SIZE_INT);
+
+  monitoring_start_tile(who);
+
+  div4[0] = div4[width + 1] = 0;
+
+  for (int i = y; i < y + height; i++)
+  {
+    // Each cell of the row is read once, so the lanes hold at most a quarter
+    // of the grains of the row
+    vec_int_t vtopples = vec_set1(0);
+    TYPE lanes[VEC_SIZE_INT];
+    int j;
+
+    for (j = x; j < vec_end; j += VEC_SIZE_INT)
+    {
+      vec_int_t v = vec_load(table_cell(TABLE, i, j));
+      vec_int_t d = vec_srli(v, 2);
+
+      vec_store(table_cell(TABLE, i, j), vec_and(v, three));
+      vec_store(div4 + j - x + 1, d);
+      vec_store(table_cell(TABLE, i - 1, j),
+                vec_add(vec_load(table_cell(TABLE, i - 1, j)), d));
+      vec_store(table_cell(TABLE, i + 1, j),
+                vec_add(vec_load(table_cell(TABLE, i + 1, j)), d));
+      vchange = vec_or(vchange, d);
+      vtopples = vec_add(vtopples, d);
+    }
+    for (; j < x + width; j++)
+    {
+      TYPE d = table(i, j) >> 2;
+
+      table(i, j) &= 3;
+      div4[j - x + 1] = d;
+      table(i - 1, j) += d;
+      table(i + 1, j) += d;
+      change |= d;
+      topples += d;
+    }
+    vec_store(lanes, vtopples);
+    for (int l = 0; l < VEC_SIZE_INT; l++)
+      topples += lanes[l];
+
+    for (j = x; j < vec_end; j += VEC_SIZE_INT)
+    {
+      vec_int_t in = vec_add(vec_load(div4 + j - x), vec_load(div4 + j - x + 2));
+      vec_store(table_cell(TABLE, i, j),
+                vec_add(vec_load(table_cell(TABLE, i, j)), in));
+    }
+    for (; j < x + width; j++)
+      table(i, j) += div4[j - x] + div4[j - x + 2];
+
+    // Grains leaving the tile through its left and right borders
+    table(i, x - 1) += div4[1];
+    table(i, x + width) += div4[width];
+  }
+
+  monitoring_end_tile(x, y, width, height, who);
+
+  tile_metrics(who, width * height, topples);
+
+  return change != 0 || !vec_is_zero(vchange);
+}
+
+void sable_init_tiled_vec(void)
+{
+  easypap_check_vectorization(VEC_TYPE_INT, DIR_HORIZONTAL);
+  sable_init();
+}
+
+void sable_init_omp_vec(void)
+{
+  sable_init_tiled_vec();
+}
+
+unsigned sable_compute_tiled_vec(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    changement = 0;
+
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        changement |= do_tile_vec(x + (x == 0), y + (y == 0),
+                                  TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                                  TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                                  0 /* CPU id */);
+    if (changement == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned sable_compute_omp_vec(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    changement = 0;
+
+#pragma omp parallel
+    for (int phase = 0; phase < 4; phase++)
+    {
+      // Same checkerboard as sable_compute_tiled_omp
+      const int oy = (phase == 1 || phase == 3) ? TILE_H : 0;
+      const int ox = (phase == 1 || phase == 2) ? TILE_W : 0;
+
+#pragma omp for collapse(2) reduction(| \
+                                      : changement) schedule(runtime)
+      for (int y = oy; y < DIM; y += 2 * TILE_H)
+        for (int x = ox; x < DIM; x += 2 * TILE_W)
+          changement |= do_tile_vec(x + (x == 0), y + (y == 0),
+                                    TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                                    TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                                    omp_get_thread_num());
+    }
+
+    if (changement == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+#endif
+
+///////////////////////////// Version synchrone (sync)
+// Same gather formulation as the sable_ocl kernel: every cell keeps in % 4
+// and receives in >> 2 from each of its neighbors. Reads only touch TABLE
+// and writes only touch ALT_TABLE, so all tiles can be computed in any order
+// within a single parallel region. Border cells stay at 0 in both tables, so
+// they never give grains back.
+
+void sable_init_sync(void)
+{
+  sable_init();
+
+  if (ALT_TABLE == NULL)
+  {
+    const size_t size = table_size();
+
+    PRINT_DEBUG('u', "Additional memory footprint = %zu bytes\n", size);
+
+    ALT_TABLE = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ALT_TABLE == MAP_FAILED)
+      exit_with_error("Cannot allocate %zu bytes for the table", size);
+
+    mem_policy_apply(ALT_TABLE, size);
+    mem_policy_register("ALT_TABLE", ALT_TABLE, size);
+  }
+}
+
+void sable_init_sync_omp(void)
+{
+  sable_init_sync();
+}
+
+void sable_finalize_sync(void)
+{
+  munmap(ALT_TABLE, table_size());
+  sable_finalize();
+}
+
+void sable_finalize_sync_omp(void)
+{
+  sable_finalize_sync();
+}
+
+static inline void swap_tables(void)
+{
+  TYPE *tmp = TABLE;
+  TABLE = ALT_TABLE;
+  ALT_TABLE = tmp;
+}
+
+static int do_tile_sync(int x, int y, int width, int height, int who)
+{
+  TYPE change = 0;
+  uint64_t topples = 0;
+
+  monitoring_start_tile(who);
+
+  for (int i = y; i < y + height; i++)
+    for (int j = x; j < x + width; j++)
+    {
+      TYPE c = table(i, j);
+      TYPE n = (c & 3) + (table(i, j - 1) >> 2) + (table(i, j + 1) >> 2) +
+               (table(i - 1, j) >> 2) + (table(i + 1, j) >> 2);
+
+      alt_table(i, j) = n;
+      change |= n ^ c;
+      topples += c >> 2;
+    }
+
+  monitoring_end_tile(x, y, width, height, who);
+
+  // One read of TABLE and one write of ALT_TABLE per cell
+  tile_metrics(who, width * height, topples);
+
+  return change != 0;
+}
+
+unsigned sable_compute_sync(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    changement = 0;
+
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        changement |= do_tile_sync(x + (x == 0), y + (y == 0),
+                                   TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                                   TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                                   0 /* CPU id */);
+    swap_tables();
+
+    if (changement == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned sable_compute_sync_omp(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    changement = 0;
+
+#pragma omp parallel for collapse(2) reduction(| \
+                                               : changement) schedule(runtime)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        changement |= do_tile_sync(x + (x == 0), y + (y == 0),
+                                   TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                                   TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                                   omp_get_thread_num());
+    swap_tables();
+
+    if (changement == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+#ifdef ENABLE_VECTO
+
+static int do_tile_sync_vec(int x, int y, int width, int height, int who)
+{
+  TYPE change = 0;
+  uint64_t topples = 0;
+  vec_int_t vchange = vec_set1(0);
+  const vec_int_t three = vec_set1(3);
+  const int vec_end = x + width - (width % VEC_SIZE_INT);
+
+  monitoring_start_tile(who);
+
+  for (int i = y; i < y + height; i++)
+  {
+    vec_int_t vtopples = vec_set1(0);
+    TYPE lanes[VEC_SIZE_INT];
+    int j;
+
+    for (j = x; j < vec_end; j += VEC_SIZE_INT)
+    {
+      vec_int_t c = vec_load(table_cell(TABLE, i, j));
+      vec_int_t n = vec_and(c, three);
+
+      n = vec_add(n, vec_srli(vec_load(table_cell(TABLE, i, j - 1)), 2));
+      n = vec_add(n, vec_srli(vec_load(table_cell(TABLE, i, j + 1)), 2));
+      n = vec_add(n, vec_srli(vec_load(table_cell(TABLE, i - 1, j)), 2));
+      n = vec_add(n, vec_srli(vec_load(table_cell(TABLE, i + 1, j)), 2));
+
+      vec_store(table_cell(ALT_TABLE, i, j), n);
+      vchange = vec_or(vchange, vec_xor(n, c));
+      vtopples = vec_add(vtopples, vec_srli(c, 2));
+    }
+    for (; j < x + width; j++)
+    {
+      TYPE c = table(i, j);
+      TYPE n = (c & 3) + (table(i, j - 1) >> 2) + (table(i, j + 1) >> 2) +
+               (table(i - 1, j) >> 2) + (table(i + 1, j) >> 2);
+
+      alt_table(i, j) = n;
+      change |= n ^ c;
+      topples += c >> 2;
+    }
+    vec_store(lanes, vtopples);
+    for (int l = 0; l < VEC_SIZE_INT; l++)
+      topples += lanes[l];
+  }
+
+  monitoring_end_tile(x, y, width, height, who);
+
+  tile_metrics(who, width * height, topples);
+
+  return change != 0 || !vec_is_zero(vchange);
+}
+
+void sable_init_sync_omp_vec(void)
+{
+  easypap_check_vectorization(VEC_TYPE_INT, DIR_HORIZONTAL);
+  sable_init_sync();
+}
+
+void sable_finalize_sync_omp_vec(void)
+{
+  sable_finalize_sync();
+}
+
+unsigned sable_compute_sync_omp_vec(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    changement = 0;
+
+#pragma omp parallel for collapse(2) reduction(| \
+                                               : changement) schedule(runtime)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        changement |= do_tile_sync_vec(x + (x == 0), y + (y == 0),
+                                       TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                                       TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                                       omp_get_thread_num());
+    swap_tables();
+
+    if (changement == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+#endif
+
+///////////////////////////// Version équipe persistante (team)
+// Same computations as tiled_omp and sync_omp, but a single parallel region
+// spans all iterations (see include/team.h): phases are separated by spin
+// barriers instead of fork/join, which matters for small DIM.
+//
+// Suggested cmdline:
+// OMP_NUM_THREADS=8 ./run -k sable -v sync_team -s 256 -ts 16 -n
+
+void sable_init_tiled_team(void)
+{
+  sable_init();
+  team_init();
+}
+
+void sable_finalize_tiled_team(void)
+{
+  team_finalize();
+  sable_finalize();
+}
+
+static void tiled_team_body(void)
+{
+  for (int phase = 0; phase < 4; phase++)
+  {
+    if (phase > 0)
+      team_barrier();
+    team_for_tile_subset(do_tile_trimmed, (phase == 1 || phase == 2),
+                         (phase == 1 || phase == 3), 2);
+  }
+}
+
+unsigned sable_compute_tiled_team(unsigned nb_iter)
+{
+  return team_run(nb_iter, tiled_team_body, NULL);
+}
+
+void sable_init_sync_team(void)
+{
+  sable_init_sync();
+  team_init();
+}
+
+void sable_finalize_sync_team(void)
+{
+  team_finalize();
+  sable_finalize_sync();
+}
+
+static int do_tile_sync_trimmed(int x, int y, int width, int height, int who)
+{
+  return do_tile_sync(x + (x == 0), y + (y == 0),
+                      width - ((x + width == DIM) + (x == 0)),
+                      height - ((y + height == DIM) + (y == 0)), who);
+}
+
+static void sync_team_body(void)
+{
+  team_for_tiles(do_tile_sync_trimmed);
+}
+
+unsigned sable_compute_sync_team(unsigned nb_iter)
+{
+  return team_run(nb_iter, sync_team_body, swap_tables);
+}
+
+///////////////////////////// Version à blocage temporel (tblock)
+// Each tile is loaded with a halo of TBLOCK_DEPTH cells into a thread-local
+// buffer, where TBLOCK_DEPTH synchronous steps are performed in cache. The
+// region holding exact values shrinks by one cell per step, so the tile
+// interior is still exact after the last step and is written back to
+// ALT_TABLE. TABLE is thus streamed once every TBLOCK_DEPTH iterations.
+// Suggested cmdline:
+// ./run -k sable -v tblock_omp -s 4096 -ts 64 -ka 8 -n
+
+static unsigned TBLOCK_DEPTH = 4;
+static TYPE **tblock_buffers = NULL;
+static int tblock_nb_buffers = 0;
+
+// Parses the -ka argument as an integer in [min, max]
+static unsigned parse_kernel_arg(const char *what, long min, long max)
+{
+  char *end;
+  long v = strtol(kernel_arg, &end, 10);
+
+  if (end == kernel_arg || *end != '\0' || v < min || v > max)
+    exit_with_error("%s must be an integer in [%ld, %ld] (got \"%s\")", what,
+                    min, max, kernel_arg);
+
+  return v;
+}
+
+void sable_init_tblock(void)
+{
+  sable_init_sync();
+
+  // A halo deeper than the tile only adds redundant work
+  if (kernel_arg != NULL)
+    TBLOCK_DEPTH = parse_kernel_arg("Temporal blocking depth", 1,
+                                    min(TILE_W, TILE_H));
+
+  PRINT_DEBUG('u', "Temporal blocking depth = %u\n", TBLOCK_DEPTH);
+
+  if (tblock_buffers == NULL)
+  {
+    const unsigned size = 2 * (TILE_W + 2 * TBLOCK_DEPTH) *
+                          (TILE_H + 2 * TBLOCK_DEPTH) * sizeof(TYPE);
+
+    tblock_nb_buffers = omp_get_max_threads();
+    tblock_buffers = malloc(tblock_nb_buffers * sizeof(TYPE *));
+    for (int t = 0; t < tblock_nb_buffers; t++)
+      tblock_buffers[t] = malloc(size);
+  }
+}
+
+void sable_init_tblock_omp(void)
+{
+  sable_init_tblock();
+}
+
+void sable_finalize_tblock(void)
+{
+  for (int t = 0; t < tblock_nb_buffers; t++)
+    free(tblock_buffers[t]);
+  free(tblock_buffers);
+
+  sable_finalize_sync();
+}
+
+void sable_finalize_tblock_omp(void)
+{
+  sable_finalize_tblock();
+}
+
+// Computes 'steps' synchronous iterations of tile (x, y) and returns the last
+// step at which a cell changed (0 if none did)
+static int do_tile_tblock(int x, int y, int steps, int who)
+{
+  const int k = TBLOCK_DEPTH;
+  const int lw = TILE_W + 2 * k;
+  const int lh = TILE_H + 2 * k;
+  const int gx = x - k; // global coordinates of the buffer origin
+  const int gy = y - k;
+  const int dim = DIM;
+  TYPE *restrict in = tblock_buffers[who];
+  TYPE *restrict out = in + lw * lh;
+  int last = 0;
+  unsigned cells = 0;
+  uint64_t topples = 0;
+
+#define local(b, r, c) ((b)[(r)*lw + (c)])
+
+  monitoring_start_tile(who);
+
+  // Cells outside the grid or on its border act as a sink and stay at 0
+  if (gx < 1 || gy < 1 || gx + lw > dim - 1 || gy + lh > dim - 1)
+  {
+    memset(in, 0, 2 * lw * lh * sizeof(TYPE));
+    for (int r = 0; r < lh; r++)
+      if (gy + r >= 1 && gy + r < dim - 1)
+        for (int c = max(0, 1 - gx); c < min(lw, dim - 1 - gx); c++)
+          local(in, r, c) = table(gy + r, gx + c);
+  }
+  else
+    for (int r = 0; r < lh; r++)
+      memcpy(&local(in, r, 0), table_cell(TABLE, gy + r, gx), lw * sizeof(TYPE));
+
+  for (int s = 1; s <= steps; s++)
+  {
+    const int rmin = max(s, 1 - gy), rmax = min(lh - s, dim - 1 - gy);
+    const int cmin = max(s, 1 - gx), cmax = min(lw - s, dim - 1 - gx);
+    TYPE change = 0;
+
+    cells += (rmax - rmin) * (cmax - cmin);
+
+    for (int r = rmin; r < rmax; r++)
+    {
+      // Halo cells are recomputed by neighbor tiles, so only topplings of the
+      // tile interior are counted
+      const int interior = (r >= k && r < k + TILE_H);
+
+      for (int c = cmin; c < cmax; c++)
+      {
+        TYPE v = local(in, r, c);
+        TYPE n = (v & 3) + (local(in, r, c - 1) >> 2) +
+                 (local(in, r, c + 1) >> 2) + (local(in, r - 1, c) >> 2) +
+                 (local(in, r + 1, c) >> 2);
+
+        local(out, r, c) = n;
+        change |= n ^ v;
+        topples += (interior && c >= k && c < k + TILE_W) ? v >> 2 : 0;
+      }
+    }
+
+    if (change)
+      last = s;
+
+    TYPE *tmp = in;
+    in = out;
+    out = tmp;
+  }
+
+  // Write back the tile interior
+  for (int i = max(y, 1); i < min(y + TILE_H, dim - 1); i++)
+    for (int j = max(x, 1); j < min(x + TILE_W, dim - 1); j++)
+      alt_table(i, j) = local(in, i - gy, j - gx);
+
+#undef local
+
+  monitoring_end_tile(x, y, TILE_W, TILE_H, who);
+
+  // TABLE is read once with its halo, ALT_TABLE written once
+  metrics_add(who, METRIC_CELLS, cells);
+  metrics_add(who, METRIC_TOPPLES, topples);
+  metrics_add(who, METRIC_BYTES, (lw * lh + TILE_W * TILE_H) * sizeof(TYPE));
+
+  return last;
+}
+
+unsigned sable_compute_tblock(unsigned nb_iter)
+{
+  for (unsigned it = 0; it < nb_iter; it += TBLOCK_DEPTH)
+  {
+    const int steps = min(TBLOCK_DEPTH, nb_iter - it);
+    int last = 0;
+
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        last = max(last, do_tile_tblock(x, y, steps, 0 /* CPU id */));
+    swap_tables();
+
+    // Same return value as sable_compute_sync
+    if (last < steps)
+      return it + last + 1;
+  }
+
+  return 0;
+}
+
+unsigned sable_compute_tblock_omp(unsigned nb_iter)
+{
+  for (unsigned it = 0; it < nb_iter; it += TBLOCK_DEPTH)
+  {
+    const int steps = min(TBLOCK_DEPTH, nb_iter - it);
+    int last = 0;
+
+#pragma omp parallel for collapse(2) reduction(max \
+                                               : last) schedule(runtime)
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        last = max(last, do_tile_tblock(x, y, steps, omp_get_thread_num()));
+    swap_tables();
+
+    if (last < steps)
+      return it + last + 1;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version compacte (compact)
+// Same traversal as tiled/tiled_omp, but on one byte per cell (see
+// "Stockage compact" above). Memory footprint and bandwidth are divided by 4
+// as long as few cells hold OVERFLOW_MARK grains or more.
+// Suggested cmdline:
+// ./run -k sable -v compact_omp -a alea -s 8192 -ts 32 -n
+
+void sable_init_compact(void)
+{
+  if (CTABLE == NULL)
+  {
+    const size_t size = (size_t)DIM * DIM * sizeof(CTYPE);
+
+    PRINT_DEBUG('u', "Memory footprint = %zu bytes\n", size);
+
+    CTABLE = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    mem_policy_apply(CTABLE, size);
+    mem_policy_register("CTABLE", CTABLE, size);
+
+    overflow_capacity = 0;
+    overflow_resize(1024);
+    compact_mode = true;
+  }
+}
+
+void sable_init_compact_omp(void)
+{
+  sable_init_compact();
+}
+
+void sable_finalize_compact(void)
+{
+  const size_t size = (size_t)DIM * DIM * sizeof(CTYPE);
+
+  PRINT_DEBUG('u', "%d overflowed cells left\n", overflow_count);
+
+  munmap(CTABLE, size);
+  free(overflow);
+}
+
+void sable_finalize_compact_omp(void)
+{
+  sable_finalize_compact();
+}
+
+// Returns the number of topplings of cell (y, x), like compute_new_state
+static inline unsigned compute_new_state_compact(int y, int x)
+{
+  CTYPE c = ctable(y, x);
+
+  if (c < 4)
+    return 0;
+
+  TYPE v = (c == OVERFLOW_MARK) ? compact_get(y, x) : c;
+  TYPE div4 = v / 4;
+
+  compact_add(y, x - 1, div4);
+  compact_add(y, x + 1, div4);
+  compact_add(y - 1, x, div4);
+  compact_add(y + 1, x, div4);
+  compact_set(y, x, v % 4);
+
+  return div4;
+}
+
+static int do_tile_compact(int x, int y, int width, int height, int who)
+{
+  uint64_t topples = 0;
+
+  monitoring_start_tile(who);
+
+  for (int i = y; i < y + height; i++)
+    for (int j = x; j < x + width; j++)
+      topples += compute_new_state_compact(i, j);
+
+  monitoring_end_tile(x, y, width, height, who);
+
+  // Overflowed cells are rare, only the compact table is accounted for
+  metrics_add(who, METRIC_CELLS, width * height);
+  metrics_add(who, METRIC_TOPPLES, topples);
+  metrics_add(who, METRIC_BYTES, 2 * (uint64_t)width * height * sizeof(CTYPE));
+
+  return topples != 0;
+}
+
+unsigned sable_compute_compact(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    changement = 0;
+
+    for (int y = 0; y < DIM; y += TILE_H)
+      for (int x = 0; x < DIM; x += TILE_W)
+        changement |= do_tile_compact(x + (x == 0), y + (y == 0),
+                                      TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                                      TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                                      0 /* CPU id */);
+    if (changement == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+unsigned sable_compute_compact_omp(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    changement = 0;
+
+#pragma omp parallel
+    for (int phase = 0; phase < 4; phase++)
+    {
+      // Same checkerboard as sable_compute_tiled_omp
+      const int oy = (phase == 1 || phase == 3) ? TILE_H : 0;
+      const int ox = (phase == 1 || phase == 2) ? TILE_W : 0;
+
+#pragma omp for collapse(2) reduction(| \
+                                      : changement) schedule(runtime)
+      for (int y = oy; y < DIM; y += 2 * TILE_H)
+        for (int x = ox; x < DIM; x += 2 * TILE_W)
+          changement |= do_tile_compact(x + (x == 0), y + (y == 0),
+                                        TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                                        TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                                        omp_get_thread_num());
+    }
+
+    if (changement == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version tâches (task)
+// One task per tile and per iteration. A tile updates itself and the borders
+// of its 4 neighbors, so its task is ordered after the previously created
+// tasks of its 8 neighbors (diagonal ones included, since they share corner
+// cells with the tiles it writes to). Tasks are created in the checkerboard
+// order of tiled_omp, so a tile starts as soon as its neighbors are done and
+// several sweeps can be in flight: use -r N to pipeline up to N iterations.
+//
+// Suggested cmdline:
+// ./run -k sable -v task -s 2048 -ts 32 -r 8 -n
+
+#define TASK_WINDOW 8 // sweeps in flight before checking for stability
+
+// One dependency token per tile, plus a halo of tokens never written to
+static char *task_deps = NULL;
+
+#define task_dep(ty, tx) task_deps[((ty) + 1) * (NB_TILES_X + 2) + (tx) + 1]
+
+void sable_init_task(void)
+{
+  sable_init();
+
+  if (task_deps == NULL)
+    task_deps = calloc((NB_TILES_Y + 2) * (NB_TILES_X + 2), sizeof(char));
+}
+
+void sable_finalize_task(void)
+{
+  free(task_deps);
+  task_deps = NULL;
+
+  sable_finalize();
+}
+
+unsigned sable_compute_task(unsigned nb_iter)
+{
+  unsigned changes[TASK_WINDOW];
+
+  for (unsigned it = 1; it <= nb_iter; it += TASK_WINDOW)
+  {
+    const int window = min(TASK_WINDOW, (int)(nb_iter - it + 1));
+
+    for (int k = 0; k < window; k++)
+      changes[k] = 0;
+
+#pragma omp parallel
+#pragma omp single
+    for (int k = 0; k < window; k++)
+      for (int phase = 0; phase < 4; phase++)
+      {
+        const int py = (phase == 1 || phase == 3);
+        const int px = (phase == 1 || phase == 2);
+
+        for (int ty = py; ty < NB_TILES_Y; ty += 2)
+          for (int tx = px; tx < NB_TILES_X; tx += 2)
+#pragma omp task firstprivate(k, ty, tx) depend(inout : task_dep(ty, tx))      \
+    depend(in : task_dep(ty - 1, tx - 1), task_dep(ty - 1, tx),                 \
+               task_dep(ty - 1, tx + 1), task_dep(ty, tx - 1),                  \
+               task_dep(ty, tx + 1), task_dep(ty + 1, tx - 1),                  \
+               task_dep(ty + 1, tx), task_dep(ty + 1, tx + 1))
+          {
+            int x = tx * TILE_W;
+            int y = ty * TILE_H;
+
+            if (do_tile(x + (x == 0), y + (y == 0),
+                        TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                        TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                        omp_get_thread_num()))
+              __atomic_store_n(&changes[k], 1, __ATOMIC_RELAXED);
+          }
+      }
+
+    // A sweep without change leaves the table untouched, so the sweeps
+    // following it in the window were no-ops
+    for (int k = 0; k < window; k++)
+      if (changes[k] == 0)
+        return it + k;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Version asynchrone (async)
+// The final configuration does not depend on the toppling order, so there is
+// no need for global sweeps. Each thread owns a band of tiles and a queue of
+// its unstable tiles. It sweeps them once and pushes back the neighbors
+// whose border received grains (into the queue of their owner), as well as
+// the tile itself until it is stable. Sweeping a tile until it is stable
+// before releasing it makes grains bounce back and forth across tile
+// borders, and turns out to be slower. Idle threads steal tiles from other
+// queues.
+//
+// Two tiles processed at the same time must not be 8-neighbors, as they
+// would update the same border cells: a thread marks its tile busy, then
+// checks that no neighbor is busy (otherwise it backs off and requeues the
+// tile). Queues have their own lock, so there is no global critical section.
+//
+// The whole computation is done in a single call to compute: -i is ignored,
+// and the call returns 1 once the table is stable.
+//
+// Suggested cmdline:
+// ./run -k sable -v async -s 2048 -ts 32 -n
+
+typedef struct
+{
+  omp_lock_t lock;
+  unsigned head, size;
+  int *tiles; // ring of tile indexes
+} __attribute__((aligned(64))) async_queue_t;
+
+static async_queue_t *async_queues = NULL;
+static int async_nb_queues = 0;
+static char *async_queued = NULL; // tile is in some queue
+static char *async_busy = NULL;   // tile is being swept
+static int async_pending;         // queued or busy tiles
+
+void sable_init_async(void)
+{
+  sable_init();
+
+  if (async_queues == NULL)
+  {
+    async_nb_queues = omp_get_max_threads();
+    async_queues = malloc(async_nb_queues * sizeof(async_queue_t));
+    for (int q = 0; q < async_nb_queues; q++)
+    {
+      omp_init_lock(&async_queues[q].lock);
+      async_queues[q].tiles = malloc(NB_TILES_X * NB_TILES_Y * sizeof(int));
+    }
+    async_queued = calloc(NB_TILES_X * NB_TILES_Y, sizeof(char));
+    async_busy = calloc(NB_TILES_X * NB_TILES_Y, sizeof(char));
+  }
+}
+
+void sable_finalize_async(void)
+{
+  for (int q = 0; q < async_nb_queues; q++)
+  {
+    omp_destroy_lock(&async_queues[q].lock);
+    free(async_queues[q].tiles);
+  }
+  free(async_queues);
+  free(async_queued);
+  free(async_busy);
+  sable_finalize();
+}
+
+static inline int async_owner(int t)
+{
+  return (t / NB_TILES_X) * async_nb_queues / NB_TILES_Y;
+}
+
+static void async_enqueue(int t)
+{
+  async_queue_t *q = &async_queues[async_owner(t)];
+
+  omp_set_lock(&q->lock);
+  q->tiles[(q->head + q->size++) % (NB_TILES_X * NB_TILES_Y)] = t;
+  omp_unset_lock(&q->lock);
+}
+
+// Queues tile (ty, tx) unless it is already queued
+static void async_push(int ty, int tx)
+{
+  const int t = ty * NB_TILES_X + tx;
+
+  if (__atomic_load_n(&async_queued[t], __ATOMIC_RELAXED) ||
+      __atomic_exchange_n(&async_queued[t], 1, __ATOMIC_ACQ_REL))
+    return;
+
+  __atomic_add_fetch(&async_pending, 1, __ATOMIC_RELAXED);
+  async_enqueue(t);
+}
+
+// Returns the first tile of queue q, or -1. Thieves do not wait for the lock.
+static int async_dequeue(async_queue_t *q, int steal)
+{
+  int t = -1;
+
+  if (__atomic_load_n(&q->size, __ATOMIC_RELAXED) == 0)
+    return -1;
+
+  if (steal ? !omp_test_lock(&q->lock) : (omp_set_lock(&q->lock), 0))
+    return -1;
+
+  if (q->size > 0)
+  {
+    t = q->tiles[q->head];
+    q->head = (q->head + 1) % (NB_TILES_X * NB_TILES_Y);
+    q->size--;
+  }
+  omp_unset_lock(&q->lock);
+
+  return t;
+}
+
+// Marks tile t busy if neither it (it may have been queued again while
+// being swept) nor any of its 8 neighbors is. Accesses are sequentially
+// consistent, so out of two neighbors trying at the same time, at least one
+// sees the other and backs off.
+static int async_acquire(int t)
+{
+  const int ty = t / NB_TILES_X, tx = t % NB_TILES_X;
+  char idle = 0;
+
+  if (!__atomic_compare_exchange_n(&async_busy[t], &idle, 1, 0,
+                                   __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    return 0;
+
+  for (int dy = max(ty - 1, 0); dy <= min(ty + 1, NB_TILES_Y - 1); dy++)
+    for (int dx = max(tx - 1, 0); dx <= min(tx + 1, NB_TILES_X - 1); dx++)
+      if ((dy != ty || dx != tx) &&
+          __atomic_load_n(&async_busy[dy * NB_TILES_X + dx], __ATOMIC_SEQ_CST))
+      {
+        __atomic_store_n(&async_busy[t], 0, __ATOMIC_RELEASE);
+        return 0;
+      }
+
+  return 1;
+}
+
+static TYPE row_sum(int y, int x, int width)
+{
+  TYPE sum = 0;
+
+  for (int j = x; j < x + width; j++)
+    sum += table(y, j);
+  return sum;
+}
+
+static TYPE col_sum(int y, int x, int height)
+{
+  TYPE sum = 0;
+
+  for (int i = y; i < y + height; i++)
+    sum += table(i, x);
+  return sum;
+}
+
+static void do_tile_async(int t, int who)
+{
+  const int ty = t / NB_TILES_X, tx = t % NB_TILES_X;
+  const int x = tx * TILE_W + (tx == 0);
+  const int y = ty * TILE_H + (ty == 0);
+  const int width = TILE_W - ((tx * TILE_W + TILE_W == DIM) + (tx == 0));
+  const int height = TILE_H - ((ty * TILE_H + TILE_H == DIM) + (ty == 0));
+
+  // Grains only flow out of the tile, so a neighbor was disturbed iff the
+  // border facing the tile has grown
+  TYPE up = row_sum(y - 1, x, width), down = row_sum(y + height, x, width);
+  TYPE left = col_sum(y, x - 1, height), right = col_sum(y, x + width, height);
+
+  int change = do_tile(x, y, width, height, who);
+
+  if (change)
+    async_push(ty, tx);
+  if (ty > 0 && row_sum(y - 1, x, width) != up)
+    async_push(ty - 1, tx);
+  if (ty < NB_TILES_Y - 1 && row_sum(y + height, x, width) != down)
+    async_push(ty + 1, tx);
+  if (tx > 0 && col_sum(y, x - 1, height) != left)
+    async_push(ty, tx - 1);
+  if (tx < NB_TILES_X - 1 && col_sum(y, x + width, height) != right)
+    async_push(ty, tx + 1);
+}
+
+unsigned sable_compute_async(unsigned nb_iter)
+{
+  async_pending = 0;
+  for (int q = 0; q < async_nb_queues; q++)
+    async_queues[q].head = async_queues[q].size = 0;
+  for (int ty = 0; ty < NB_TILES_Y; ty++)
+    for (int tx = 0; tx < NB_TILES_X; tx++)
+      async_push(ty, tx);
+
+#pragma omp parallel
+  {
+    const int me = omp_get_thread_num() % async_nb_queues;
+    int failures = 0;
+
+    while (__atomic_load_n(&async_pending, __ATOMIC_ACQUIRE) > 0)
+    {
+      int t = async_dequeue(&async_queues[me], 0);
+
+      for (int q = 1; t == -1 && q < async_nb_queues; q++)
+        t = async_dequeue(&async_queues[(me + q) % async_nb_queues], 1);
+
+      if (t != -1 && async_acquire(t))
+      {
+        __atomic_store_n(&async_queued[t], 0, __ATOMIC_RELEASE);
+        do_tile_async(t, omp_get_thread_num());
+        __atomic_store_n(&async_busy[t], 0, __ATOMIC_RELEASE);
+        // Neighbors pushed by do_tile_async are already counted
+        __atomic_sub_fetch(&async_pending, 1, __ATOMIC_ACQ_REL);
+        failures = 0;
+        continue;
+      }
+
+      if (t != -1)
+        async_enqueue(t); // a neighbor is busy: try again later
+
+      // Nothing to do, or only tiles next to busy ones: let the threads
+      // sweeping them run
+      if (t == -1 || ++failures > 8)
+        sched_yield();
+    }
+  }
+
+  return 1;
+}
+
+///////////////////////////// Version hiérarchique (tiled_hier)
+// STABILITY_TABLE is summarized by SUPER_TABLE, which counts the unstable
+// tiles of each group of SUPER_TILE x SUPER_TILE tiles, and by a global count
+// of unstable tiles. A quiescent group surrounded by quiescent groups is
+// skipped with a single check, and termination is detected in O(1).
+
+#define SUPER_TILE 8
+
+static unsigned *SUPER_TABLE = NULL;
+static unsigned NB_SUPER_X, NB_SUPER_Y;
+static unsigned nb_unstable_tiles;
+
+#define super_unstable(sy, sx) (SUPER_TABLE[(sy)*NB_SUPER_X + (sx)])
+
+void sable_init_tiled_hier(void)
+{
+  sable_init();
+
+  if (SUPER_TABLE == NULL)
+  {
+    NB_SUPER_X = (NB_TILES_X + SUPER_TILE - 1) / SUPER_TILE;
+    NB_SUPER_Y = (NB_TILES_Y + SUPER_TILE - 1) / SUPER_TILE;
+    SUPER_TABLE = calloc(NB_SUPER_X * NB_SUPER_Y, sizeof(unsigned));
+
+    // sable_init flags every tile as unstable
+    for (int ty = 0; ty < NB_TILES_Y; ty++)
+      for (int tx = 0; tx < NB_TILES_X; tx++)
+        super_unstable(ty / SUPER_TILE, tx / SUPER_TILE)++;
+    nb_unstable_tiles = NB_TILES_X * NB_TILES_Y;
+  }
+}
+
+void sable_init_tiled_hier_omp(void)
+{
+  sable_init_tiled_hier();
+}
+
+void sable_finalize_tiled_hier(void)
+{
+  free(SUPER_TABLE);
+  sable_finalize();
+}
+
+void sable_finalize_tiled_hier_omp(void)
+{
+  sable_finalize_tiled_hier();
+}
+
+static inline unsigned super_count(int sy, int sx)
+{
+  if (sy < 0 || sy >= NB_SUPER_Y || sx < 0 || sx >= NB_SUPER_X)
+    return 0;
+  return __atomic_load_n(&super_unstable(sy, sx), __ATOMIC_RELAXED);
+}
+
+static inline bool super_quiet(int sy, int sx)
+{
+  return super_count(sy, sx) == 0 && super_count(sy - 1, sx) == 0 &&
+         super_count(sy + 1, sx) == 0 && super_count(sy, sx - 1) == 0 &&
+         super_count(sy, sx + 1) == 0;
+}
+
+static inline TYPE tile_flag(int ty, int tx)
+{
+  if (ty < 0 || ty >= NB_TILES_Y || tx < 0 || tx >= NB_TILES_X)
+    return 0;
+  return not_stable(ty, tx);
+}
+
+static inline bool tile_quiet(int ty, int tx)
+{
+  return !(tile_flag(ty, tx) | tile_flag(ty - 1, tx) | tile_flag(ty + 1, tx) |
+           tile_flag(ty, tx - 1) | tile_flag(ty, tx + 1));
+}
+
+// Number of tiles of group (sy, sx) visited with the given stride and offsets
+static inline unsigned super_nb_tiles(int sy, int sx, int stride, int py, int px)
+{
+  int h = min((sy + 1) * SUPER_TILE, NB_TILES_Y) - sy * SUPER_TILE - py;
+  int w = min((sx + 1) * SUPER_TILE, NB_TILES_X) - sx * SUPER_TILE - px;
+
+  return max(0, (h + stride - 1) / stride) * max(0, (w + stride - 1) / stride);
+}
+
+static void do_tile_hier(int ty, int tx, int who)
+{
+  if (tile_quiet(ty, tx))
+  {
+    metrics_add(who, METRIC_SKIPPED, 1);
+    return;
+  }
+
+  int y = ty * TILE_H;
+  int x = tx * TILE_W;
+  TYPE unstable = do_tile_unstable(x + (x == 0), y + (y == 0),
+                                   TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                                   TILE_H - ((y + TILE_H == DIM) + (y == 0)),
+                                   who);
+
+  if (unstable != not_stable(ty, tx))
+  {
+    int delta = unstable ? 1 : -1;
+
+    not_stable(ty, tx) = unstable;
+    __atomic_add_fetch(&super_unstable(ty / SUPER_TILE, tx / SUPER_TILE), delta,
+                       __ATOMIC_RELAXED);
+    __atomic_add_fetch(&nb_unstable_tiles, delta, __ATOMIC_RELAXED);
+  }
+}
+
+unsigned sable_compute_tiled_hier(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    for (int sy = 0; sy < NB_SUPER_Y; sy++)
+      for (int sx = 0; sx < NB_SUPER_X; sx++)
+      {
+        if (super_quiet(sy, sx))
+        {
+          metrics_add(0, METRIC_SKIPPED, super_nb_tiles(sy, sx, 1, 0, 0));
+          continue;
+        }
+
+        for (int ty = sy * SUPER_TILE; ty < min((sy + 1) * SUPER_TILE, NB_TILES_Y); ty++)
+          for (int tx = sx * SUPER_TILE; tx < min((sx + 1) * SUPER_TILE, NB_TILES_X); tx++)
+            do_tile_hier(ty, tx, 0 /* CPU id */);
+      }
+
+    if (nb_unstable_tiles == 0)
+      return it;
+  }
+  return 0;
+}
+
+unsigned sable_compute_tiled_hier_omp(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+#pragma omp parallel
+    for (int phase = 0; phase < 4; phase++)
+    {
+      // Same checkerboard as sable_compute_tiled_omp, at the tile level.
+      // SUPER_TILE is even, so each group holds tiles of every phase.
+      const int py = (phase == 1 || phase == 3);
+      const int px = (phase == 1 || phase == 2);
+
+#pragma omp for collapse(2) schedule(runtime)
+      for (int sy = 0; sy < NB_SUPER_Y; sy++)
+        for (int sx = 0; sx < NB_SUPER_X; sx++)
+        {
+          if (super_quiet(sy, sx))
+          {
+            metrics_add(omp_get_thread_num(), METRIC_SKIPPED,
+                        super_nb_tiles(sy, sx, 2, py, px));
+            continue;
+          }
+
+          for (int ty = sy * SUPER_TILE + py; ty < min((sy + 1) * SUPER_TILE, NB_TILES_Y); ty += 2)
+            for (int tx = sx * SUPER_TILE + px; tx < min((sx + 1) * SUPER_TILE, NB_TILES_X); tx += 2)
+              do_tile_hier(ty, tx, omp_get_thread_num());
+        }
+    }
+
+    if (nb_unstable_tiles == 0)
+      return it;
+  }
+  return 0;
+}
+
+///////////////////////////// Version MPI (mpi_omp)
+// The table is split into horizontal bands of rows, one per MPI process. A
+// process only allocates its own rows and one halo row above and below, so
+// its memory footprint is that of its band (the image is still full size). Iterations are synchronous (see
+// sync), hence halos are only read: boundary rows are exchanged while the
+// rows which do not depend on halos are computed.
+//
+// Suggested cmdline:
+// ./run -k sable -v mpi_omp -mpi "-np 4" -s 2048 -n
+
+#ifdef ENABLE_MPI
+
+static int rank_above, rank_below; // MPI_PROC_NULL at the edges of the table
+
+static inline int band_start(int rank)
+{
+  return 1 + rank * (DIM - 2) / easypap_mpi_size();
+}
+
+void sable_init_mpi_omp(void)
+{
+  easypap_check_mpi();
+
+  const int rank = easypap_mpi_rank();
+  const int size = easypap_mpi_size();
+
+  band_lo = band_start(rank);
+  band_hi = band_start(rank + 1);
+  if (band_hi - band_lo < 2)
+    exit_with_error("Too many MPI processes (%d) for DIM = %d", size, DIM);
+
+  rank_above = (rank > 0 ? rank - 1 : MPI_PROC_NULL);
+  rank_below = (rank < size - 1 ? rank + 1 : MPI_PROC_NULL);
+  band_mode = true;
+  table_row0 = band_lo - 1;
+
+  PRINT_DEBUG('M', "Rows [%d-%d]\n", band_lo, band_hi - 1);
+
+  sable_init_sync();
+}
+
+void sable_finalize_mpi_omp(void)
+{
+  sable_finalize_sync();
+}
+
+void sable_ft_mpi_omp(void)
+{
+#pragma omp parallel for schedule(runtime)
+  for (int x = 0; x < DIM; x += TILE_W)
+    for (int i = band_lo - 1; i <= band_hi; i++)
+      for (int j = x; j < x + TILE_W; j++)
+      {
+        table(i, j) = alt_table(i, j) = 0;
+        if (i >= band_lo && i < band_hi)
+          cur_img(i, j) = 0;
+      }
+}
+
+// Returns the number of tiles which changed in rows [lo, hi[
+static int do_band_rows(int lo, int hi)
+{
+  int changed = 0;
+
+#pragma omp parallel for collapse(2) reduction(+ : changed) schedule(runtime)
+  for (int y = lo; y < hi; y += TILE_H)
+    for (int x = 0; x < DIM; x += TILE_W)
+      changed += do_tile_sync(x + (x == 0), y,
+                              TILE_W - ((x + TILE_W == DIM) + (x == 0)),
+                              min((int)TILE_H, hi - y), omp_get_thread_num());
+
+  return changed;
+}
+
+unsigned sable_compute_mpi_omp(unsigned nb_iter)
+{
+  for (unsigned it = 1; it <= nb_iter; it++)
+  {
+    MPI_Request req[4];
+    int changed;
+
+    MPI_Irecv(&table(band_lo - 1, 0), DIM, MPI_UNSIGNED, rank_above, 0,
+              MPI_COMM_WORLD, &req[0]);
+    MPI_Irecv(&table(band_hi, 0), DIM, MPI_UNSIGNED, rank_below, 0,
+              MPI_COMM_WORLD, &req[1]);
+    MPI_Isend(&table(band_lo, 0), DIM, MPI_UNSIGNED, rank_above, 0,
+              MPI_COMM_WORLD, &req[2]);
+    MPI_Isend(&table(band_hi - 1, 0), DIM, MPI_UNSIGNED, rank_below, 0,
+              MPI_COMM_WORLD, &req[3]);
+
+    changed = do_band_rows(band_lo + 1, band_hi - 1);
+
+    MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+
+    changed += do_band_rows(band_lo, band_lo + 1);
+    changed += do_band_rows(band_hi - 1, band_hi);
+
+    swap_tables();
+
+    MPI_Allreduce(MPI_IN_PLACE, &changed, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (changed == 0)
+      return it;
+  }
+
+  return 0;
+}
+
+// Each process renders its band, and the master gathers the image
+void sable_refresh_img_mpi_omp(void)
+{
+  const int size = easypap_mpi_size();
+  int counts[size], displs[size];
+  unsigned long int max = refresh_rows(band_lo, band_hi);
+
+  MPI_Allreduce(MPI_IN_PLACE, &max, 1, MPI_UNSIGNED_LONG, MPI_MAX,
+                MPI_COMM_WORLD);
+  max_grains = max;
+
+  for (int r = 0; r < size; r++)
+  {
+    displs[r] = band_start(r) * DIM;
+    counts[r] = band_start(r + 1) * DIM - displs[r];
+  }
+
+  if (easypap_proc_is_master())
+    MPI_Gatherv(MPI_IN_PLACE, 0, MPI_UINT32_T, image, counts, displs,
+                MPI_UINT32_T, 0, MPI_COMM_WORLD);
+  else
+    MPI_Gatherv(&cur_img(band_lo, 0), counts[easypap_mpi_rank()],
+                MPI_UINT32_T, NULL, NULL, NULL, MPI_UINT32_T, 0,
+                MPI_COMM_WORLD);
+}
+
+#endif // ENABLE_MPI
+
 ///////////////////////////// open CL
 static cl_mem changed, ocl_changes;
 static volatile int changement;
@@ -728,9 +2647,9 @@ void swap_mem(cl_mem *m1, cl_mem *m2)
 
 void sable_init_ocl(void)
 {
-  const unsigned size = DIM * DIM * sizeof(TYPE);
+  const size_t size = (size_t)DIM * DIM * sizeof(TYPE);
 
-  PRINT_DEBUG('u', "Memory footprint = 2 x %d bytes\n", size);
+  PRINT_DEBUG('u', "Memory footprint = 2 x %zu bytes\n", size);
 
   TABLE = mmap(NULL, size, PROT_READ | PROT_WRITE,
                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -802,7 +2721,7 @@ unsigned sable_invoke_ocl(unsigned nb_iter)
 }
 void sable_init_ocl_freq(void)
 {
-  const unsigned size = DIM * DIM * sizeof(TYPE);
+  const size_t size = (size_t)DIM * DIM * sizeof(TYPE);
 
   TABLE = mmap(NULL, size, PROT_READ | PROT_WRITE,
                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -886,7 +2805,7 @@ void sable_draw_4partout(void)
   max_grains = 8;
   for (int i = 1; i < DIM - 1; i++)
     for (int j = 1; j < DIM - 1; j++)
-      cur_img(i, j) = table(i, j) = 4;
+      draw_grains(i, j, 4);
 }
 
 void sable_draw_DIM(void)
@@ -894,7 +2813,7 @@ void sable_draw_DIM(void)
   max_grains = DIM;
   for (int i = DIM / 4; i < DIM - 1; i += DIM / 4)
     for (int j = DIM / 4; j < DIM - 1; j += DIM / 4)
-      cur_img(i, j) = table(i, j) = i * j / 4;
+      draw_grains(i, j, i * j / 4);
 }
 
 void sable_draw_alea(void)
@@ -905,6 +2824,6 @@ void sable_draw_alea(void)
     int i = 1 + random() % (DIM - 2);
     int j = 1 + random() % (DIM - 2);
     int grains = 1000 + (random() % (4000));
-    cur_img(i, j) = table(i, j) = grains;
+    draw_grains(i, j, grains);
   }
 }
\ No newline at end of file
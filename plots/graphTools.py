@@ -209,7 +209,7 @@ def parseArguments(argv):
                         ["custom"], default="threads")
     parser.add_argument("-heaty", choices=all+["custom"], default=None)
     parser.add_argument(
-        "-y", choices=["time", "speedup", "throughput", "efficiency", "custom"], default="speedup")
+        "-y", choices=["time", "speedup", "throughput", "efficiency", "gups", "bandwidth", "custom"], default="speedup")
 
     parser.add_argument('-rtv', '--RefTimeVariants',
                         action='store', nargs='+',
@@ -379,6 +379,18 @@ def parseArguments(argv):
     return args
 
 
+def rateFromCounter(df, counter, attr):
+    # Older files lack the counter columns, and kernels which do not count
+    # leave them empty: such rows are dropped
+    if counter not in df.columns:
+        sys.exit("No '" + counter + "' column in this file (recorded before work counters)")
+    df[attr] = pds.to_numeric(df[counter], errors='coerce') / df['time'] / 1000
+    df = df.dropna(subset=[attr]).reset_index(drop=True)
+    if df.empty:
+        sys.exit("No '" + counter + "' value recorded by the selected kernels")
+    return df
+
+
 def getDataFrame(args):
     # Lecture du fichier d'experiences:
     df = openfile(args.input, sepa=";")
@@ -402,6 +414,19 @@ def getDataFrame(args):
         for attr in args.delete:
             del df[attr]
 
+    # Work counters (see include/metrics.h) are results, not parameters
+    if args.y == "gups":
+        args.y = 'GUPS (Gcells / s)'
+        df = rateFromCounter(df, 'cells', args.y)
+
+    if args.y == "bandwidth":
+        args.y = 'bandwidth (GB / s)'
+        df = rateFromCounter(df, 'bytes', args.y)
+
+    for attr in ['cells', 'topples', 'skipped', 'bytes']:
+        if attr in df.columns:
+            del df[attr]
+
     if args.y == "speedup":
         df = computeSpeedUpAttr(df, args)
 
@@ -11,10 +11,12 @@ _easypap_completions()
 {
     local LONG_OPTIONS=("--help" "--load-image" "--size" "--kernel" "--variant" "--monitoring" "--thumbnails"
                         "--trace" "--no-display" "--iterations" "--nb-tiles" "--tile-size" "--arg" "--first-touch"
-                        "--label" "--mpirun" "--soft-rendering" "--show-ocl" "--tile-width" "--tile-height")
+                        "--label" "--mpirun" "--soft-rendering" "--show-ocl" "--tile-width" "--tile-height" "--interleave"
+                        "--kernel-arg")
     local SHORT_OPTIONS=("-h" "-l" "-s" "-k" "-v" "-m" "-tn"
                          "-t" "-n" "-i" "-nt" "-ts" "-a" "-ft"
-                         "-lb" "-mpi" "-sr" "-so" "-tw" "-th")
+                         "-lb" "-mpi" "-sr" "-so" "-tw" "-th" "-il"
+                         "-ka")
     local NB_OPTIONS=${#LONG_OPTIONS[@]}
 
     local exclude_s=(1) # size excludes load-image
@@ -127,7 +129,7 @@ _easypap_completions()
                     COMPREPLY=("\"${MPIRUN_DEFAULT:-"-np 2"}\"")
                 fi
                 ;;
-            -n|--no-display|-m|--monitoring|-t|--trace|-th|--thumbs|-ft|--first-touch|-du|--dump|-p|--pause|-sr|--soft-rendering|-o|--ocl)
+            -n|--no-display|-m|--monitoring|-t|--trace|-th|--thumbs|-ft|--first-touch|-il|--interleave|-du|--dump|-p|--pause|-sr|--soft-rendering|-o|--ocl)
                 # After options taking no argument, we can suggest another option
                 if [[ "$cur" =~ ^--.* ]]; then
                     _easypap_option_suggest "${LONG_OPTIONS[@]}"
@@ -6,6 +6,7 @@
 #include "error.h"
 #include "global.h"
 #include "img_data.h"
+#include "mem_policy.h"
 
 uint32_t *restrict image = NULL, *restrict alt_image = NULL;
 
@@ -28,6 +29,11 @@ void img_data_alloc (void)
   if (alt_image == NULL)
     exit_with_error ("Cannot allocate alternate image: mmap failed");
 
+  mem_policy_apply (image, DIM * DIM * sizeof (uint32_t));
+  mem_policy_apply (alt_image, DIM * DIM * sizeof (uint32_t));
+  mem_policy_register ("image", image, DIM * DIM * sizeof (uint32_t));
+  mem_policy_register ("alt_image", alt_image, DIM * DIM * sizeof (uint32_t));
+
   PRINT_DEBUG ('i', "Init phase 4: images allocated\n");
 }
 
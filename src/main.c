@@ -1,5 +1,6 @@
 #include <fcntl.h>
 #include <hwloc.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/time.h>
@@ -31,6 +32,7 @@ static char *progname    = NULL;
 char *variant_name       = NULL;
 char *kernel_name        = NULL;
 char *draw_param         = NULL;
+char *kernel_arg         = NULL;
 char *easypap_image_file = NULL;
 
 static char *output_file = "./plots/data/perf_data.csv";
@@ -146,29 +148,57 @@ static void update_refresh_rate (int p)
   printf ("< Refresh rate set to: %d >\n", refresh_rate);
 }
 
+// Metrics columns are only appended to files which have them already (or
+// new files), so that older CSV files remain consistent
+static int csv_has_metrics (FILE *f)
+{
+  char header[1024];
+
+  rewind (f);
+  if (fgets (header, sizeof (header), f) == NULL)
+    return 1;
+
+  return strstr (header, ";time;") != NULL;
+}
+
 static void output_perf_numbers (long time_in_us, unsigned nb_iter)
 {
-  FILE *f = fopen (output_file, "a");
+  FILE *f = fopen (output_file, "a+");
   struct utsname s;
+  int metrics;
 
   if (f == NULL)
     exit_with_error ("Cannot open \"%s\" file (%s)", output_file,
                      strerror (errno));
 
+  metrics = csv_has_metrics (f);
+
+  fseek (f, 0, SEEK_END);
   if (ftell (f) == 0) {
-    fprintf (f, "%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s\n", "machine", "size",
+    fprintf (f, "%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s", "machine", "size",
              "tilew", "tileh", "threads", "kernel", "variant", "iterations",
              "schedule", "places", "label", "arg", "time");
+    for (int m = 0; m < METRIC_NB; m++)
+      fprintf (f, ";%s", metric_names[m]);
+    fprintf (f, "\n");
   }
 
   if (uname (&s) < 0)
     exit_with_error ("uname failed (%s)", strerror (errno));
 
-  fprintf (f, "%s;%u;%u;%u;%u;%s;%s;%u;%s;%s;%s;%s;%ld\n", s.nodename, DIM,
+  fprintf (f, "%s;%u;%u;%u;%u;%s;%s;%u;%s;%s;%s;%s;%ld", s.nodename, DIM,
            TILE_W, TILE_H, easypap_requested_number_of_threads (), kernel_name,
            variant_name, nb_iter, easypap_omp_schedule (),
            easypap_omp_places (), trace_label, (draw_param ?: "none"),
            time_in_us);
+  if (metrics) {
+    for (int m = 0; m < METRIC_NB; m++)
+      if (metrics_counted & (1ULL << m))
+        fprintf (f, ";%llu", (unsigned long long)metrics_total[m]);
+      else
+        fprintf (f, ";"); // not counted by this kernel
+  }
+  fprintf (f, "\n");
 
   fclose (f);
 }
@@ -264,6 +294,8 @@ static void init_phases (void)
   /* Perform the topology detection. */
   hwloc_topology_load (topology);
 
+  mem_policy_init (topology);
+
   nb_cores = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_PU);
   PRINT_DEBUG ('t', "%d-core machine detected\n", nb_cores);
 
@@ -299,6 +331,8 @@ static void init_phases (void)
   check_tile_size ();
 
 #ifdef ENABLE_MONITORING
+  metrics_init (easypap_requested_number_of_threads ());
+
 #ifdef ENABLE_TRACE
   if (do_trace) {
     char filename[1024];
@@ -563,6 +597,9 @@ int main (int argc, char **argv)
     if (refresh_rate == -1) {
       if (max_iter)
         refresh_rate = max_iter;
+      else if (team_enabled ())
+        // Let the persistent team run until the end
+        refresh_rate = INT_MAX;
       else
         refresh_rate = 1;
     }
@@ -612,9 +649,21 @@ int main (int argc, char **argv)
 
     temps = TIME_DIFF (t1, t2);
 
+#ifdef ENABLE_MPI
+    // Each process only counted the work done on its own part of the data
+    if (easypap_mpirun) {
+      MPI_Allreduce (MPI_IN_PLACE, metrics_total, METRIC_NB, MPI_UINT64_T,
+                     MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce (MPI_IN_PLACE, &metrics_counted, 1, MPI_UINT64_T, MPI_BOR,
+                     MPI_COMM_WORLD);
+    }
+#endif
+
     if (easypap_proc_is_master ())
       output_perf_numbers (temps, iterations);
 
+    mem_policy_report (iterations, temps);
+
     PRINT_MASTER ("%ld.%03ld \n", temps / 1000, temps % 1000);
   }
 
@@ -654,6 +703,10 @@ int main (int argc, char **argv)
 
   img_data_free ();
 
+  mem_policy_clean ();
+
+  metrics_finalize ();
+
 #ifdef ENABLE_MPI
   if (easypap_mpirun)
     MPI_Finalize ();
@@ -676,6 +729,11 @@ static void usage (int val)
            "\t-ft\t| --first-touch\t\t: touch memory on different cores\n");
   fprintf (stderr, "\t-h\t| --help\t\t: display help\n");
   fprintf (stderr, "\t-i\t| --iterations <n>\t: stop after n iterations\n");
+  fprintf (stderr,
+           "\t-il\t| --interleave\t\t: interleave memory pages across NUMA "
+           "nodes\n");
+  fprintf (stderr, "\t-ka\t| --kernel-arg <string>\t: pass argument <string> to "
+                   "the kernel variant\n");
   fprintf (stderr,
            "\t-k\t| --kernel <name>\t: override KERNEL environment variable\n");
   fprintf (stderr,
@@ -753,6 +811,8 @@ static void filter_args (int *argc, char *argv[])
       do_display        = 0;
     } else if (!strcmp (*argv, "--first-touch") || !strcmp (*argv, "-ft")) {
       do_first_touch = 1;
+    } else if (!strcmp (*argv, "--interleave") || !strcmp (*argv, "-il")) {
+      do_interleave = 1;
     } else if (!strcmp (*argv, "--monitoring") || !strcmp (*argv, "-m")) {
 #ifndef ENABLE_SDL
       fprintf (stderr, "Warning: cannot monitor execution when ENABLE_SDL is "
@@ -790,6 +850,14 @@ static void filter_args (int *argc, char *argv[])
       (*argc)--;
       argv++;
       draw_param = *argv;
+    } else if (!strcmp (*argv, "--kernel-arg") || !strcmp (*argv, "-ka")) {
+      if (*argc == 1) {
+        fprintf (stderr, "Error: parameter string is missing\n");
+        usage (1);
+      }
+      (*argc)--;
+      argv++;
+      kernel_arg = *argv;
     } else if (!strcmp (*argv, "--label") || !strcmp (*argv, "-lb")) {
       if (*argc == 1) {
         fprintf (stderr, "Error: parameter string is missing\n");
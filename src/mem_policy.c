@@ -0,0 +1,113 @@
+#include <hwloc.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "debug.h"
+#include "mem_policy.h"
+
+#define MAX_AREAS 16
+
+unsigned do_interleave = 0;
+
+static hwloc_topology_t topology = NULL; // owned by main
+
+static struct area
+{
+  const char *name;
+  void *addr;
+  size_t len;
+} areas[MAX_AREAS];
+static unsigned nb_areas = 0;
+
+void mem_policy_init (hwloc_topology_t topo)
+{
+  topology = topo;
+}
+
+void mem_policy_apply (void *addr, size_t len)
+{
+  if (!do_interleave || addr == NULL || topology == NULL)
+    return;
+
+  if (hwloc_set_area_membind (topology, addr, len,
+                              hwloc_topology_get_topology_nodeset (topology),
+                              HWLOC_MEMBIND_INTERLEAVE,
+                              HWLOC_MEMBIND_BYNODESET) < 0)
+    fprintf (stderr, "Warning: cannot interleave memory pages\n");
+  else
+    PRINT_DEBUG ('n', "%zu bytes interleaved across NUMA nodes\n", len);
+}
+
+void mem_policy_register (const char *name, void *addr, size_t len)
+{
+  if (nb_areas == MAX_AREAS || addr == NULL)
+    return;
+
+  areas[nb_areas].name = name;
+  areas[nb_areas].addr = addr;
+  areas[nb_areas].len  = len;
+  nb_areas++;
+}
+
+void mem_policy_report (unsigned nb_iter, long time_in_us)
+{
+  if (!debug_enabled ('n') || nb_areas == 0 || topology == NULL)
+    return;
+
+  const int nb_nodes = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_NUMANODE);
+  const long page    = sysconf (_SC_PAGESIZE);
+  size_t bytes[nb_nodes + 1]; // last entry: pages not allocated yet
+  hwloc_nodeset_t set = hwloc_bitmap_alloc ();
+
+  for (int n = 0; n <= nb_nodes; n++)
+    bytes[n] = 0;
+
+  for (int a = 0; a < nb_areas; a++) {
+    size_t per_node[nb_nodes + 1];
+
+    for (int n = 0; n <= nb_nodes; n++)
+      per_node[n] = 0;
+
+    for (size_t off = 0; off < areas[a].len; off += page) {
+      size_t len = areas[a].len - off < page ? areas[a].len - off : page;
+      int n      = nb_nodes;
+
+      if (hwloc_get_area_memlocation (topology, (char *)areas[a].addr + off,
+                                      len, set, HWLOC_MEMBIND_BYNODESET) == 0 &&
+          !hwloc_bitmap_iszero (set)) {
+        hwloc_obj_t node = hwloc_get_numanode_obj_by_os_index (
+            topology, hwloc_bitmap_first (set));
+        if (node != NULL)
+          n = node->logical_index;
+      }
+      per_node[n] += len;
+    }
+
+    for (int n = 0; n <= nb_nodes; n++) {
+      if (per_node[n] == 0)
+        continue;
+      if (n < nb_nodes)
+        PRINT_DEBUG ('n', "%s: %zu KiB on node %d\n", areas[a].name,
+                     per_node[n] / 1024, n);
+      else
+        PRINT_DEBUG ('n', "%s: %zu KiB not allocated\n", areas[a].name,
+                     per_node[n] / 1024);
+      bytes[n] += per_node[n];
+    }
+  }
+
+  hwloc_bitmap_free (set);
+
+  // Not a measurement: actual traffic depends on caches and on the kernel
+  for (int n = 0; n < nb_nodes; n++)
+    PRINT_DEBUG ('n',
+                 "Node %d: %.1f MiB, estimated %.1f MB/s (one pass per "
+                 "iteration)\n",
+                 n, (double)bytes[n] / (1 << 20),
+                 time_in_us ? (double)bytes[n] * nb_iter / time_in_us : 0.0);
+}
+
+void mem_policy_clean (void)
+{
+  nb_areas = 0;
+}
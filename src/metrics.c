@@ -0,0 +1,58 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "metrics.h"
+#include "trace_record.h"
+
+char *metric_names[METRIC_NB + 1] = {"cells", "topples", "skipped", "bytes",
+                                     NULL};
+
+uint64_t metrics_total[METRIC_NB] = {0};
+
+uint64_t metrics_counted = 0;
+
+#ifdef ENABLE_MONITORING
+
+metrics_slot_t *metrics_slots = NULL;
+
+static unsigned nb_slots = 0;
+
+void metrics_init (unsigned nb_threads)
+{
+  nb_slots      = nb_threads;
+  metrics_slots = aligned_alloc (sizeof (metrics_slot_t),
+                                 nb_slots * sizeof (metrics_slot_t));
+  if (metrics_slots == NULL)
+    exit_with_error ("Cannot allocate metrics for %d threads", nb_slots);
+
+  memset (metrics_slots, 0, nb_slots * sizeof (metrics_slot_t));
+}
+
+// Threads are idle between two compute calls, so their counters can be
+// collected and reset without synchronization
+void metrics_end_iteration (void)
+{
+  uint64_t sum[METRIC_NB] = {0};
+
+  for (unsigned t = 0; t < nb_slots; t++) {
+    for (int m = 0; m < METRIC_NB; m++)
+      sum[m] += metrics_slots[t].count[m];
+    metrics_counted |= metrics_slots[t].counted;
+  }
+
+  memset (metrics_slots, 0, nb_slots * sizeof (metrics_slot_t));
+
+  for (int m = 0; m < METRIC_NB; m++)
+    metrics_total[m] += sum[m];
+
+  trace_record_metrics (METRIC_NB, metric_names, sum);
+}
+
+void metrics_finalize (void)
+{
+  free (metrics_slots);
+  metrics_slots = NULL;
+}
+
+#endif
@@ -0,0 +1,43 @@
+#include "park.h"
+
+#ifdef __linux__
+
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+void park_wait (int *addr, int val)
+{
+  syscall (SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+void park_wake (int *addr, int n)
+{
+  syscall (SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+#else
+
+// No futex: all parked threads share one condition variable
+#include <pthread.h>
+
+static pthread_mutex_t park_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t park_cond   = PTHREAD_COND_INITIALIZER;
+
+void park_wait (int *addr, int val)
+{
+  pthread_mutex_lock (&park_mutex);
+  if (__atomic_load_n (addr, __ATOMIC_SEQ_CST) == val)
+    pthread_cond_wait (&park_cond, &park_mutex);
+  pthread_mutex_unlock (&park_mutex);
+}
+
+void park_wake (int *addr, int n)
+{
+  pthread_mutex_lock (&park_mutex);
+  pthread_cond_broadcast (&park_cond);
+  pthread_mutex_unlock (&park_mutex);
+}
+
+#endif
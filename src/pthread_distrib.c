@@ -3,6 +3,8 @@
 
 #include <errno.h>
 
+static __thread pthread_distrib_t *current = NULL;
+
 int pthread_distrib_init (pthread_distrib_t *distrib, unsigned nb_threads,
                           unsigned nb_elements, void (*f) (void))
 {
@@ -11,20 +13,8 @@ int pthread_distrib_init (pthread_distrib_t *distrib, unsigned nb_threads,
     return -1;
   }
 
-  if (pthread_mutex_init (&distrib->mutex, 0) < 0) {
-    return -1;
-  }
-
-  if (pthread_cond_init (&distrib->cond, 0) < 0) {
-    int errno_save = errno;
-    pthread_mutex_destroy (&distrib->mutex);
-    errno = errno_save;
+  if (spin_barrier_init (&distrib->barrier, nb_threads) < 0)
     return -1;
-  }
-
-  distrib->limit = nb_threads;
-  distrib->count = 0;
-  distrib->phase = 0;
 
   distrib->total_elements = nb_elements;
   distrib->next_element   = 0;
@@ -33,38 +23,28 @@ int pthread_distrib_init (pthread_distrib_t *distrib, unsigned nb_threads,
   return 0;
 }
 
-int pthread_distrib_get (pthread_distrib_t *distrib)
+// Called by the last thread joining the barrier
+static void end_of_phase (void)
 {
-  pthread_mutex_lock (&distrib->mutex);
-
-  if (distrib->next_element == distrib->total_elements) {
-    // No more job to distribute. Join barrier and return -1
+  current->next_element = 0;
 
-    distrib->count++;
-    if (distrib->count >= distrib->limit) {
-      distrib->phase++;
-      distrib->count        = 0;
-      distrib->next_element = 0;
+  if (current->finalize_func != NULL)
+    current->finalize_func ();
+}
 
-      if (distrib->finalize_func != NULL)
-        distrib->finalize_func ();
+int pthread_distrib_get (pthread_distrib_t *distrib)
+{
+  // Each thread increments the counter at most once past total_elements
+  // before joining the barrier, which resets it
+  unsigned e =
+      __atomic_fetch_add (&distrib->next_element, 1, __ATOMIC_RELAXED);
 
-      pthread_cond_broadcast (&distrib->cond);
-      pthread_mutex_unlock (&distrib->mutex);
-    } else {
-      unsigned phase = distrib->phase;
-      do
-        pthread_cond_wait (&distrib->cond, &distrib->mutex);
-      while (phase == distrib->phase);
+  if (e < distrib->total_elements)
+    return e;
 
-      pthread_mutex_unlock (&distrib->mutex);
-    }
-    return -1;
-  } else {
-    // Get one element
-    int e = distrib->next_element++;
+  // No more job to distribute. Join barrier and return -1
+  current = distrib;
+  spin_barrier_single (&distrib->barrier, end_of_phase);
 
-    pthread_mutex_unlock (&distrib->mutex);
-    return e;
-  }
+  return -1;
 }
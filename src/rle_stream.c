@@ -0,0 +1,296 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "global.h"
+#include "rle_stream.h"
+
+///////////////////////////// Loader
+
+// Sets cells [first, last] of row
+static void fill_run (void *row, int layout, int first, int last)
+{
+  if (layout == RLE_LAYOUT_CELLS) {
+    unsigned *cells = row;
+
+    for (int i = first; i <= last; i++)
+      cells[i] = 1;
+  } else {
+    uint64_t *words = row;
+    int w0 = first / 64, w1 = last / 64;
+    uint64_t head = ~(uint64_t)0 << (first % 64);
+    uint64_t tail = ~(uint64_t)0 >> (63 - last % 64);
+
+    if (w0 == w1)
+      words[w0] |= head & tail;
+    else {
+      words[w0] |= head;
+      memset (words + w0 + 1, 0xFF, (w1 - w0 - 1) * sizeof (uint64_t));
+      words[w1] |= tail;
+    }
+  }
+}
+
+static void skip_blanks (const char **p, const char *end)
+{
+  while (*p < end && (**p == ' ' || **p == '\t'))
+    (*p)++;
+}
+
+static void expect (const char **p, const char *end, char c, char *filename)
+{
+  skip_blanks (p, end);
+  if (*p == end || **p != c)
+    exit_with_error ("\"%s\": '%c' expected in RLE header", filename, c);
+  (*p)++;
+}
+
+static unsigned parse_number (const char **p, const char *end, char *filename)
+{
+  unsigned n = 0;
+
+  skip_blanks (p, end);
+  if (*p == end || **p < '0' || **p > '9')
+    exit_with_error ("\"%s\": number expected in RLE header", filename);
+
+  while (*p < end && **p >= '0' && **p <= '9')
+    n = n * 10 + *(*p)++ - '0';
+
+  return n;
+}
+
+void rle_stream_parse (char *filename, int xo, int yo, int orientation,
+                       int layout, rle_row_func_t row_func)
+{
+  struct stat st;
+  int fd;
+
+  fd = open (filename, O_RDONLY);
+  if (fd == -1)
+    exit_with_error ("Cannot open file \"%s\": %s", filename, strerror (errno));
+
+  if (fstat (fd, &st) < 0 || st.st_size == 0)
+    exit_with_error ("\"%s\": empty or unreadable RLE file", filename);
+
+  const char *map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    exit_with_error ("Cannot map file \"%s\": %s", filename, strerror (errno));
+
+  madvise ((void *)map, st.st_size, MADV_SEQUENTIAL);
+
+  const char *p = map, *end = map + st.st_size;
+
+  // Comments and blank lines
+  while (p < end && (*p == '#' || *p == '\n' || *p == '\r')) {
+    const char *eol = memchr (p, '\n', end - p);
+    p               = eol ? eol + 1 : end;
+  }
+
+  // x = <width>, y = <height>[, rule = ...]: sizes are not needed
+  expect (&p, end, 'x', filename);
+  expect (&p, end, '=', filename);
+  parse_number (&p, end, filename);
+  expect (&p, end, ',', filename);
+  expect (&p, end, 'y', filename);
+  expect (&p, end, '=', filename);
+  parse_number (&p, end, filename);
+  p = memchr (p, '\n', end - p);
+  if (p == NULL)
+    exit_with_error ("\"%s\": no RLE data", filename);
+
+  int xdir = 1, ydir = 1;
+
+  if (orientation & RLE_ORIENTATION_HINVERT) {
+    xo   = DIM - 1 - xo;
+    xdir = -1;
+  }
+  if (orientation & RLE_ORIENTATION_VINVERT) {
+    yo   = DIM - 1 - yo;
+    ydir = -1;
+  }
+
+  int x = xo, y = yo;
+  unsigned n = 0;    // pending run length
+  void *row  = NULL; // current row, fetched on its first live cell
+
+  for (; p < end; p++) {
+    const char c = *p;
+
+    if (c >= '0' && c <= '9') {
+      n = n * 10 + c - '0';
+      continue;
+    }
+
+    const int count = n ? n : 1;
+
+    switch (c) {
+    case 'o': {
+      // Cells [x, x + count[ or ]x - count, x], clipped to the area
+      int first = xdir > 0 ? x : x - count + 1;
+      int last  = xdir > 0 ? x + count - 1 : x;
+
+      first = first < 0 ? 0 : first;
+      last  = last >= (int)DIM ? DIM - 1 : last;
+
+      if (first <= last && y >= 0 && y < DIM) {
+        if (row == NULL)
+          row = row_func (y);
+        fill_run (row, layout, first, last);
+      }
+    }
+      // fall through
+    case 'b':
+      x += count * xdir;
+      break;
+    case '$':
+      y += count * ydir;
+      x   = xo;
+      row = NULL;
+      break;
+    case '!':
+      p = end;
+      break;
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      continue; // a run length may be split across lines
+    default:
+      exit_with_error ("\"%s\": unexpected character '%c' in RLE data",
+                       filename, c);
+    }
+    n = 0;
+  }
+
+  munmap ((void *)map, st.st_size);
+}
+
+///////////////////////////// Generator
+
+#define OUT_SIZE 65536
+#define LINE_MAX_LEN 70
+
+typedef struct
+{
+  int fd;
+  int col;
+  unsigned len;
+  char buffer[OUT_SIZE];
+} rle_out_t;
+
+static void out_flush (rle_out_t *out)
+{
+  if (write (out->fd, out->buffer, out->len) != out->len)
+    exit_with_error ("Cannot write RLE file: %s", strerror (errno));
+  out->len = 0;
+}
+
+static void out_string (rle_out_t *out, const char *s, unsigned len)
+{
+  if (out->len + len > OUT_SIZE)
+    out_flush (out);
+  memcpy (out->buffer + out->len, s, len);
+  out->len += len;
+}
+
+// Same line wrapping as write_n_c in rle_lexer.l
+static void out_run (rle_out_t *out, unsigned n, char c)
+{
+  char tmp[16];
+  int len = sizeof (tmp);
+
+  tmp[--len] = c;
+  if (n > 1)
+    for (; n; n /= 10)
+      tmp[--len] = '0' + n % 10;
+
+  if (out->col + (int)sizeof (tmp) - len > LINE_MAX_LEN) {
+    out_string (out, "\n", 1);
+    out->col = 0;
+  }
+  out_string (out, tmp + len, sizeof (tmp) - len);
+  out->col += sizeof (tmp) - len;
+}
+
+// Returns the first cell of row in [x, end[ whose state is alive, or end
+static int next_cell (const void *row, int layout, int x, int end, int alive)
+{
+  if (layout == RLE_LAYOUT_CELLS) {
+    const unsigned *cells = row;
+
+    while (x < end && (cells[x] != 0) != alive)
+      x++;
+  } else {
+    const uint64_t *words = row;
+
+    while (x < end) {
+      uint64_t w = alive ? words[x / 64] : ~words[x / 64];
+
+      w >>= x % 64;
+      if (w) {
+        x += __builtin_ctzll (w);
+        break;
+      }
+      x = (x / 64 + 1) * 64; // skip the rest of the word
+    }
+    if (x > end)
+      x = end;
+  }
+
+  return x;
+}
+
+void rle_stream_generate (int x, int y, int width, int height, int layout,
+                          rle_row_func_t row_func, char *filename)
+{
+  rle_out_t *out = malloc (sizeof (rle_out_t));
+  char header[80];
+
+  out->fd = open (filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (out->fd == -1)
+    exit_with_error ("Cannot create file \"%s\": %s", filename,
+                     strerror (errno));
+  out->len = out->col = 0;
+
+  int len = snprintf (header, sizeof (header),
+                      "#C RLE file generated by EasyPAP\nx = %d, y = %d\n",
+                      width, height);
+  out_string (out, header, len);
+
+  unsigned empty_rows = 0; // pending '$'
+
+  for (int i = y; i < y + height; i++) {
+    const void *row = row_func (i);
+    int j           = x;
+
+    while (j < x + width) {
+      int first = next_cell (row, layout, j, x + width, 1);
+      if (first == x + width)
+        break;
+      int last = next_cell (row, layout, first, x + width, 0);
+
+      if (empty_rows) {
+        out_run (out, empty_rows, '$');
+        empty_rows = 0;
+      }
+      if (first > j)
+        out_run (out, first - j, 'b');
+      out_run (out, last - first, 'o');
+      j = last;
+    }
+    empty_rows++;
+  }
+  out_run (out, 1, '!');
+
+  out_flush (out);
+  close (out->fd);
+  free (out);
+}
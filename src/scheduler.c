@@ -1,30 +1,67 @@
 
 #define _GNU_SOURCE
 #include <hwloc.h>
+#include <limits.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "debug.h"
 #include "global.h"
+#include "park.h"
 #include "scheduler.h"
 
+// Each worker owns a Chase-Lev deque: it pushes and pops tasks at the bottom
+// end without locking, while idle workers steal tasks from the top end of a
+// victim chosen at random. Tasks submitted by threads which are not workers
+// are first deposited into the inbox of a worker, which is protected by a
+// mutex and drained by its owner (or by thieves). Inboxes are lists of
+// fixed-size segments, so they can hold any number of tasks. Tasks pinned to
+// a worker are never stolen.
+//
+// Idle workers spin (then yield) for a while, then park on the work_seq
+// futex. The number of pending tasks is an atomic counter, on which
+// scheduler_task_wait parks.
+
 static int nbWorkers = -1;
 
-volatile static int nbTask = 0;
-pthread_mutex_t mutex      = PTHREAD_MUTEX_INITIALIZER;
-pthread_cond_t cond        = PTHREAD_COND_INITIALIZER;
+static int nbTask    = 0; // pending tasks
+static int work_seq  = 0; // incremented each time tasks are submitted
+static int nb_parked = 0;
+static int finished  = 0;
 
 static hwloc_topology_t topology;
 static unsigned nb_cores;
 
-#define WORK_QUEUE 1024
+static __thread int my_worker = -1;
+
+#define SEGMENT_SIZE 1024
+#define DEQUE_INIT_SIZE 256
+#define SPIN_ROUNDS 256
 
 struct task
 {
   task_func_t fun;
   void *p;
+  int pinned; // must run on the worker it was submitted to
+};
+
+// Circular array of a deque. Arrays are never freed while workers run since
+// thieves may still read an old one after it has been replaced.
+struct task_array
+{
+  long size; // power of two
+  struct task_array *prev;
+  struct task tasks[];
+};
+
+struct segment
+{
+  struct segment *next;
+  unsigned d, f; // tasks[d..f[ are pending
+  struct task tasks[SEGMENT_SIZE];
 };
 
 struct worker
@@ -32,73 +69,466 @@ struct worker
   int id;
   pthread_t tid;
   pthread_attr_t attr;
-  pthread_cond_t cond;
+  unsigned seed;
+
+  // Chase-Lev deque
+  long top, bottom;
+  struct task_array *array;
+
+  // Inbox for tasks submitted from outside
   pthread_mutex_t mutex;
-  int fin, todo;
-  struct task tasks[WORK_QUEUE];
-  unsigned d, f;
-} * workers;
+  struct segment *head, *tail, *spare;
+  unsigned todo;
+} __attribute__ ((aligned (64))) * workers;
 
-void scheduler_task_wait ()
+static struct task_array *task_array_alloc (long size, struct task_array *prev)
+{
+  struct task_array *a =
+      malloc (sizeof (struct task_array) + size * sizeof (struct task));
+
+  a->size = size;
+  a->prev = prev;
+  return a;
+}
+
+static struct task_array *deque_grow (struct worker *w, long top, long bottom)
 {
-  pthread_mutex_lock (&mutex);
-  while (nbTask > 0)
-    pthread_cond_wait (&cond, &mutex);
-  pthread_mutex_unlock (&mutex);
+  struct task_array *old = w->array;
+  struct task_array *a   = task_array_alloc (old->size * 2, old);
+
+  for (long i = top; i < bottom; i++)
+    a->tasks[i & (a->size - 1)] = old->tasks[i & (old->size - 1)];
+
+  __atomic_store_n (&w->array, a, __ATOMIC_RELEASE);
+  return a;
 }
 
-static void one_more_task ()
+// Owner only
+static void deque_push (struct worker *w, struct task t)
 {
-  pthread_mutex_lock (&mutex);
-  nbTask++;
-  pthread_mutex_unlock (&mutex);
+  long b               = __atomic_load_n (&w->bottom, __ATOMIC_RELAXED);
+  long top             = __atomic_load_n (&w->top, __ATOMIC_ACQUIRE);
+  struct task_array *a = __atomic_load_n (&w->array, __ATOMIC_RELAXED);
+
+  if (b - top > a->size - 1)
+    a = deque_grow (w, top, b);
+
+  a->tasks[b & (a->size - 1)] = t;
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+  __atomic_store_n (&w->bottom, b + 1, __ATOMIC_RELAXED);
 }
 
-static void one_less_task ()
+// Owner only
+static int deque_take (struct worker *w, struct task *t)
+{
+  long b               = __atomic_load_n (&w->bottom, __ATOMIC_RELAXED) - 1;
+  struct task_array *a = __atomic_load_n (&w->array, __ATOMIC_RELAXED);
+  long top;
+  int ok = 0;
+
+  __atomic_store_n (&w->bottom, b, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  top = __atomic_load_n (&w->top, __ATOMIC_RELAXED);
+
+  if (top <= b) {
+    *t = a->tasks[b & (a->size - 1)];
+    ok = 1;
+    if (top == b) {
+      // Last task: race against thieves
+      ok = __atomic_compare_exchange_n (&w->top, &top, top + 1, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+      __atomic_store_n (&w->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+  } else
+    __atomic_store_n (&w->bottom, b + 1, __ATOMIC_RELAXED);
+
+  return ok;
+}
+
+static int deque_steal (struct worker *w, struct task *t)
+{
+  long top = __atomic_load_n (&w->top, __ATOMIC_ACQUIRE);
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  long b = __atomic_load_n (&w->bottom, __ATOMIC_ACQUIRE);
+
+  if (top < b) {
+    struct task_array *a = __atomic_load_n (&w->array, __ATOMIC_ACQUIRE);
+
+    *t = a->tasks[top & (a->size - 1)];
+    if (t->pinned)
+      return 0;
+    return __atomic_compare_exchange_n (&w->top, &top, top + 1, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+  }
+  return 0;
+}
+
+static struct segment *segment_alloc (struct worker *w)
+{
+  struct segment *seg = w->spare;
+
+  if (seg != NULL)
+    w->spare = NULL;
+  else
+    seg = malloc (sizeof (struct segment));
+
+  seg->next = NULL;
+  seg->d = seg->f = 0;
+  return seg;
+}
+
+// Must be called with w->mutex held
+static void inbox_push_locked (struct worker *w, struct task t)
+{
+  if (w->tail->f == SEGMENT_SIZE) {
+    w->tail->next = segment_alloc (w);
+    w->tail       = w->tail->next;
+  }
+  w->tail->tasks[w->tail->f++] = t;
+  w->todo++;
+}
+
+// Returns the next task of the inbox, moving to the next segment when the
+// head one is used up. Must be called with w->mutex held and w->todo > 0
+static struct task *inbox_peek_locked (struct worker *w)
+{
+  if (w->head->d == SEGMENT_SIZE) {
+    struct segment *empty = w->head;
+
+    w->head = empty->next;
+    free (w->spare);
+    w->spare = empty;
+  }
+  return &w->head->tasks[w->head->d];
+}
+
+// Must be called with w->mutex held and w->todo > 0
+static struct task inbox_pop_locked (struct worker *w)
+{
+  struct task t = *inbox_peek_locked (w);
+
+  w->head->d++;
+  w->todo--;
+  return t;
+}
+
+// Pushes the nb tasks (task, params + i * stride)
+static void inbox_push_many (struct worker *w, task_func_t task, char *params,
+                             size_t stride, unsigned nb, int pinned)
+{
+  pthread_mutex_lock (&w->mutex);
+  for (unsigned i = 0; i < nb; i++)
+    inbox_push_locked (w, (struct task){task, params + i * stride, pinned});
+  pthread_mutex_unlock (&w->mutex);
+}
+
+// Moves half of the inbox of w (all of it if w == me) into the deque of me.
+// Thieves stop at the first pinned task.
+static int inbox_steal (struct worker *me, struct worker *w)
+{
+  unsigned nb, moved = 0;
+
+  if (__atomic_load_n (&w->todo, __ATOMIC_RELAXED) == 0)
+    return 0;
+
+  pthread_mutex_lock (&w->mutex);
+  nb = (w == me ? w->todo : (w->todo + 1) / 2);
+  while (moved < nb) {
+    if (w != me && inbox_peek_locked (w)->pinned)
+      break;
+    deque_push (me, inbox_pop_locked (w));
+    moved++;
+  }
+  pthread_mutex_unlock (&w->mutex);
+
+  return moved > 0;
+}
+
+static void signal_work (int n)
 {
-  pthread_mutex_lock (&mutex);
-  nbTask--;
-  if (nbTask == 0)
-    pthread_cond_signal (&cond);
-  pthread_mutex_unlock (&mutex);
+  __atomic_add_fetch (&work_seq, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&nb_parked, __ATOMIC_SEQ_CST) > 0)
+    park_wake (&work_seq, n);
 }
 
-static void add_task (struct task todo, int w)
+void scheduler_task_wait ()
 {
-  one_more_task ();
-  pthread_mutex_lock (&workers[w].mutex);
-  workers[w].tasks[workers[w].f] = todo;
-  workers[w].f                   = (workers[w].f + 1) % WORK_QUEUE;
-  workers[w].todo++;
-  assert (workers[w].todo < WORK_QUEUE);
-  pthread_cond_signal (&workers[w].cond);
-  pthread_mutex_unlock (&workers[w].mutex);
+  int n;
+
+  for (int i = 0; i < SPIN_ROUNDS; i++) {
+    if (__atomic_load_n (&nbTask, __ATOMIC_ACQUIRE) == 0)
+      return;
+    cpu_relax ();
+  }
+
+  while ((n = __atomic_load_n (&nbTask, __ATOMIC_ACQUIRE)) > 0)
+    park_wait (&nbTask, n);
 }
 
-static void no_more_task (int w)
+static void one_less_task ()
 {
-  pthread_mutex_lock (&workers[w].mutex);
-  workers[w].fin = 1;
-  pthread_cond_signal (&workers[w].cond);
-  pthread_mutex_unlock (&workers[w].mutex);
+  if (__atomic_sub_fetch (&nbTask, 1, __ATOMIC_ACQ_REL) == 0)
+    park_wake (&nbTask, INT_MAX);
 }
 
+// A task submitted with cpu != -1 is pinned: it runs on worker cpu. When
+// cpu == -1, a task submitted by a worker goes to its own deque, and a task
+// submitted from outside goes to the inbox of the next worker in a
+// round-robin fashion; idle workers may steal it.
 void scheduler_create_task (task_func_t task, void *param, unsigned cpu)
 {
   struct task todo;
 
-  todo.p   = param;
-  todo.fun = task;
+  todo.p      = param;
+  todo.fun    = task;
+  todo.pinned = (cpu != -1);
+
+  __atomic_add_fetch (&nbTask, 1, __ATOMIC_RELAXED);
 
-  if (cpu == -1) {
-    static int cyclic = 0;
-    // We quickly go through the list of workers to find an idle one, or the
-    // least busy one
-    PRINT_DEBUG ('s', "Dynamic task scheduling is not yet implemented\n");
-    cpu    = cyclic;
-    cyclic = (cyclic + 1) % nbWorkers;
+  if (cpu == -1 && my_worker != -1)
+    deque_push (&workers[my_worker], todo);
+  else {
+    if (cpu == -1) {
+      static int cyclic = 0;
+      cpu    = cyclic;
+      cyclic = (cyclic + 1) % nbWorkers;
+    }
+    if (cpu == my_worker)
+      deque_push (&workers[cpu], todo);
+    else
+      inbox_push_many (&workers[cpu], task, param, 0, 1, todo.pinned);
   }
-  add_task (todo, cpu);
+
+  // Only worker cpu can run a pinned task, and we don't know which parked
+  // worker a single wake-up would reach
+  signal_work (todo.pinned ? INT_MAX : 1);
+}
+
+// Same placement policy as scheduler_create_task, except that when cpu == -1
+// tasks submitted from outside are split into contiguous chunks, one per
+// worker. Each inbox is locked once and workers are woken up once.
+void scheduler_create_tasks (task_func_t task, void *params, size_t stride,
+                             unsigned nb, unsigned cpu)
+{
+  char *p = params;
+
+  if (nb == 0)
+    return;
+
+  __atomic_add_fetch (&nbTask, nb, __ATOMIC_RELAXED);
+
+  if (my_worker != -1 && (cpu == -1 || cpu == my_worker))
+    for (unsigned i = 0; i < nb; i++)
+      deque_push (&workers[my_worker],
+                  (struct task){task, p + i * stride, cpu != -1});
+  else if (cpu != -1)
+    inbox_push_many (&workers[cpu], task, p, stride, nb, 1);
+  else
+    for (int w = 0; w < nbWorkers; w++) {
+      unsigned first = (unsigned long)nb * w / nbWorkers;
+      unsigned last  = (unsigned long)nb * (w + 1) / nbWorkers;
+
+      inbox_push_many (&workers[w], task, p + first * stride, stride,
+                       last - first, 0);
+    }
+
+  signal_work (INT_MAX);
+}
+
+// Submits one task per worker, pinned to it: task w gets parameter w. Every
+// worker is woken up, since each one has a task that nobody else can run.
+static void create_task_per_worker (task_func_t task)
+{
+  __atomic_add_fetch (&nbTask, nbWorkers, __ATOMIC_RELAXED);
+
+  for (unsigned long w = 0; w < nbWorkers; w++)
+    if (w == my_worker)
+      deque_push (&workers[w], (struct task){task, (void *)w, 1});
+    else
+      inbox_push_many (&workers[w], task, (char *)w, 0, 1, 1);
+
+  signal_work (INT_MAX);
+}
+
+static int find_task (struct worker *me, struct task *t)
+{
+  if (deque_take (me, t))
+    return 1;
+
+  if (inbox_steal (me, me) && deque_take (me, t))
+    return 1;
+
+  for (int i = 1; i < nbWorkers; i++) {
+    struct worker *victim = &workers[rand_r (&me->seed) % nbWorkers];
+
+    if (victim == me)
+      continue;
+    if (deque_steal (victim, t))
+      return 1;
+    if (inbox_steal (me, victim) && deque_take (me, t))
+      return 1;
+  }
+
+  return 0;
+}
+
+///////////////////////////// Placement
+// Workers fill physical cores in the logical order of the topology tree
+// before using hyperthreads, so that consecutive workers share caches
+// whenever possible. Tiles are ordered along a Hilbert curve, which is cut
+// into one segment per worker: neighboring tiles belong to the same worker
+// or to workers close in the topology, and the mapping never changes.
+
+static unsigned nb_phys_cores;
+static int *tile_owner          = NULL; // NB_TILES_Y x NB_TILES_X
+static unsigned *owned_tiles    = NULL; // tiles sorted by owner, curve order
+static unsigned *first_owned    = NULL; // owned_tiles[first_owned[w]...]
+static unsigned placement_tiles = 0;
+
+// Same as owned_tiles, split into the 4 phases of checkerboard loops (step 2,
+// phase oy * 2 + ox): phase_tiles[phase_first[phase][w]...]
+static unsigned *phase_tiles    = NULL;
+static unsigned *phase_first[4] = {NULL};
+
+static hwloc_obj_t worker_pu (unsigned w)
+{
+  hwloc_obj_t core =
+      hwloc_get_obj_by_type (topology, HWLOC_OBJ_CORE, w % nb_phys_cores);
+  unsigned smt;
+
+  if (core == NULL)
+    return hwloc_get_obj_by_type (topology, HWLOC_OBJ_PU, w % nb_cores);
+
+  smt = hwloc_get_nbobjs_inside_cpuset_by_type (topology, core->cpuset,
+                                                 HWLOC_OBJ_PU);
+  return hwloc_get_obj_inside_cpuset_by_type (
+      topology, core->cpuset, HWLOC_OBJ_PU, (w / nb_phys_cores) % smt);
+}
+
+// Position of (x, y) along the Hilbert curve covering a n x n grid
+static unsigned hilbert_index (unsigned n, unsigned x, unsigned y)
+{
+  unsigned d = 0;
+
+  for (unsigned s = n / 2; s > 0; s /= 2) {
+    unsigned rx = (x & s) > 0;
+    unsigned ry = (y & s) > 0;
+
+    d += s * s * ((3 * rx) ^ ry);
+    if (ry == 0) {
+      if (rx == 1) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      unsigned t = x;
+      x          = y;
+      y          = t;
+    }
+  }
+  return d;
+}
+
+static unsigned *curve_keys;
+
+static int by_curve (const void *a, const void *b)
+{
+  unsigned ka = curve_keys[*(const unsigned *)a];
+  unsigned kb = curve_keys[*(const unsigned *)b];
+
+  return (ka > kb) - (ka < kb);
+}
+
+static void print_placement (void)
+{
+  for (int w = 0; w < nbWorkers; w++) {
+    hwloc_obj_t pu    = worker_pu (w);
+    hwloc_obj_t cache = hwloc_get_cache_covering_cpuset (topology, pu->cpuset);
+    hwloc_obj_t l3    = pu;
+
+    while (l3 != NULL && !(l3->type == HWLOC_OBJ_L3CACHE))
+      l3 = l3->parent;
+
+    fprintf (stderr, "Worker %d: PU %u, %s #%d, L3 #%d, %u tiles\n", w,
+             pu->os_index, cache ? hwloc_obj_type_string (cache->type) : "-",
+             cache ? (int)cache->logical_index : -1,
+             l3 ? (int)l3->logical_index : -1,
+             first_owned[w + 1] - first_owned[w]);
+  }
+
+  for (int ty = 0; ty < NB_TILES_Y; ty++) {
+    for (int tx = 0; tx < NB_TILES_X; tx++)
+      fprintf (stderr, "%3d", tile_owner[ty * NB_TILES_X + tx]);
+    fprintf (stderr, "\n");
+  }
+}
+
+static void placement_init (void)
+{
+  unsigned n = 1;
+
+  placement_tiles = NB_TILES_X * NB_TILES_Y;
+  if (placement_tiles == 0)
+    return;
+
+  while (n < NB_TILES_X || n < NB_TILES_Y)
+    n *= 2;
+
+  curve_keys  = malloc (placement_tiles * sizeof (unsigned));
+  tile_owner  = malloc (placement_tiles * sizeof (int));
+  owned_tiles = malloc (placement_tiles * sizeof (unsigned));
+  first_owned = malloc ((nbWorkers + 1) * sizeof (unsigned));
+
+  for (unsigned t = 0; t < placement_tiles; t++) {
+    curve_keys[t]  = hilbert_index (n, t % NB_TILES_X, t / NB_TILES_X);
+    owned_tiles[t] = t;
+  }
+  qsort (owned_tiles, placement_tiles, sizeof (unsigned), by_curve);
+  free (curve_keys);
+
+  for (int w = 0; w <= nbWorkers; w++)
+    first_owned[w] = (unsigned long)placement_tiles * w / nbWorkers;
+
+  for (int w = 0; w < nbWorkers; w++)
+    for (unsigned i = first_owned[w]; i < first_owned[w + 1]; i++)
+      tile_owner[owned_tiles[i]] = w;
+
+  phase_tiles = malloc (placement_tiles * sizeof (unsigned));
+  for (unsigned p = 0, k = 0; p < 4; p++) {
+    phase_first[p] = malloc ((nbWorkers + 1) * sizeof (unsigned));
+    for (int w = 0; w < nbWorkers; w++) {
+      phase_first[p][w] = k;
+      for (unsigned i = first_owned[w]; i < first_owned[w + 1]; i++) {
+        unsigned t = owned_tiles[i];
+
+        if ((t / NB_TILES_X) % 2 * 2 + (t % NB_TILES_X) % 2 == p)
+          phase_tiles[k++] = t;
+      }
+    }
+    phase_first[p][nbWorkers] = k;
+  }
+
+  if (debug_enabled ('p'))
+    print_placement ();
+}
+
+static void placement_finalize (void)
+{
+  free (tile_owner);
+  free (owned_tiles);
+  free (first_owned);
+  free (phase_tiles);
+  for (int p = 0; p < 4; p++) {
+    free (phase_first[p]);
+    phase_first[p] = NULL;
+  }
+  tile_owner = NULL;
+}
+
+unsigned scheduler_tile_owner (unsigned tx, unsigned ty)
+{
+  if (tile_owner == NULL)
+    return (ty * NB_TILES_X + tx) % nbWorkers;
+  return tile_owner[ty * NB_TILES_X + tx];
 }
 
 static void *worker_main (void *p)
@@ -109,39 +539,232 @@ static void *worker_main (void *p)
   hwloc_obj_t obj;
   hwloc_bitmap_t set;
 
-  obj = hwloc_get_obj_by_type (topology, HWLOC_OBJ_PU, me->id % nb_cores);
+  obj = worker_pu (me->id);
   set = obj->cpuset;
   // hwloc_bitmap_singlify (set);
   hwloc_set_cpubind (topology, set, HWLOC_CPUBIND_THREAD);
 
+  my_worker = me->id;
+
   PRINT_DEBUG ('s', "Hey, I'm worker %d\n", me->id);
 
   while (1) {
-
-    pthread_mutex_lock (&me->mutex);
-
-    if (me->d == me->f && me->fin == 0)
-      pthread_cond_wait (&me->cond, &me->mutex);
-
-    if (me->d != me->f) {
-      todo  = me->tasks[me->d];
-      me->d = (me->d + 1) % WORK_QUEUE;
-      me->todo--;
-    } else if (me->fin == 1) {
-      me->fin = -1;
+    int found = 0;
+
+    for (int i = 0; i < SPIN_ROUNDS && !found; i++) {
+      found = find_task (me, &todo);
+      if (!found) {
+        // Be nice to other threads when cores are oversubscribed
+        if (i < SPIN_ROUNDS / 8)
+          cpu_relax ();
+        else
+          sched_yield ();
+      }
     }
 
-    pthread_mutex_unlock (&me->mutex);
+    if (!found) {
+      int seq = __atomic_load_n (&work_seq, __ATOMIC_SEQ_CST);
 
-    if (me->fin == -1) {
-      PRINT_DEBUG ('s', "Worker %d has computed %d tasks\n", me->id, tasks);
-      return NULL;
+      found = find_task (me, &todo);
+      if (!found) {
+        if (__atomic_load_n (&finished, __ATOMIC_SEQ_CST))
+          break;
+
+        __atomic_add_fetch (&nb_parked, 1, __ATOMIC_SEQ_CST);
+        park_wait (&work_seq, seq);
+        __atomic_sub_fetch (&nb_parked, 1, __ATOMIC_SEQ_CST);
+        continue;
+      }
     }
 
     tasks++;
     todo.fun (todo.p, me->id);
     one_less_task ();
   }
+
+  PRINT_DEBUG ('s', "Worker %d has computed %d tasks\n", me->id, tasks);
+  return NULL;
+}
+
+///////////////////////////// Parallel loops over tiles
+// One task per worker goes through the tiles of the loop, according to the
+// policy parsed from OMP_SCHEDULE at init time ("static", "dynamic,4",
+// "guided,2", ...), so that pthread and OpenMP variants can be compared
+// with the same settings. Without chunk size, the static policy gives each
+// worker the tiles it owns according to the placement.
+
+static sched_policy_t policy = SCHED_STATIC;
+static unsigned chunk        = 0; // 0 means default chunk size
+
+static struct
+{
+  tile_func_t fn;
+  reduction_t red;
+  unsigned ox, oy, step; // tiles (ox + i * step, oy + j * step)
+  unsigned nx, ny;
+  unsigned nb;   // nx * ny
+  unsigned next; // next iteration to hand out (dynamic and guided)
+} loop;
+
+static struct
+{
+  int value;
+} __attribute__ ((aligned (64))) * partial;
+
+void scheduler_set_policy (sched_policy_t p, unsigned c)
+{
+  policy = p;
+  chunk  = c;
+}
+
+static void parse_policy (void)
+{
+  char *str = getenv ("OMP_SCHEDULE");
+  char *comma;
+
+  if (str == NULL)
+    return;
+
+  if (!strncmp (str, "dynamic", 7))
+    policy = SCHED_DYNAMIC;
+  else if (!strncmp (str, "guided", 6))
+    policy = SCHED_GUIDED;
+  else
+    policy = SCHED_STATIC;
+
+  comma = strchr (str, ',');
+  chunk = (comma != NULL ? atoi (comma + 1) : 0);
+
+  PRINT_DEBUG ('s', "Tile loops scheduled with policy %d, chunk %d\n", policy,
+               chunk);
+}
+
+static void do_iterations (unsigned first, unsigned last, int *acc,
+                           unsigned who)
+{
+  for (unsigned k = first; k < last; k++) {
+    int x = (loop.ox + (k % loop.nx) * loop.step) * TILE_W;
+    int y = (loop.oy + (k / loop.nx) * loop.step) * TILE_H;
+    int r = loop.fn (x, y, TILE_W, TILE_H, who);
+
+    if (loop.red == REDUCTION_SUM)
+      *acc += r;
+    else
+      *acc |= r;
+  }
+}
+
+// Tiles of the loop owned by worker w (see placement). Full and checkerboard
+// loops use precomputed lists, other subsets are filtered on the fly.
+static void do_owned_tiles (unsigned w, int *acc, unsigned who)
+{
+  const unsigned *tiles = owned_tiles, *first = first_owned;
+  int filter            = (loop.step != 1 || loop.ox || loop.oy);
+
+  if (loop.step == 2 && loop.ox < 2 && loop.oy < 2) {
+    tiles  = phase_tiles;
+    first  = phase_first[loop.oy * 2 + loop.ox];
+    filter = 0;
+  }
+
+  for (unsigned i = first[w]; i < first[w + 1]; i++) {
+    unsigned tx = tiles[i] % NB_TILES_X;
+    unsigned ty = tiles[i] / NB_TILES_X;
+    int r;
+
+    if (filter && (tx < loop.ox || (tx - loop.ox) % loop.step ||
+                   ty < loop.oy || (ty - loop.oy) % loop.step))
+      continue;
+
+    r = loop.fn (tx * TILE_W, ty * TILE_H, TILE_W, TILE_H, who);
+    if (loop.red == REDUCTION_SUM)
+      *acc += r;
+    else
+      *acc |= r;
+  }
+}
+
+// Grabs the next chunk of iterations, returns 0 when none is left
+static int next_chunk (unsigned *first, unsigned *last)
+{
+  unsigned f = __atomic_load_n (&loop.next, __ATOMIC_RELAXED);
+  unsigned size;
+
+  do {
+    if (f >= loop.nb)
+      return 0;
+    if (policy == SCHED_GUIDED) {
+      size = (loop.nb - f) / (2 * nbWorkers);
+      if (size < (chunk ? chunk : 1))
+        size = (chunk ? chunk : 1);
+    } else
+      size = (chunk ? chunk : 1);
+  } while (!__atomic_compare_exchange_n (&loop.next, &f, f + size, 1,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+  *first = f;
+  *last  = (f + size < loop.nb ? f + size : loop.nb);
+  return 1;
+}
+
+static void loop_task (void *p, unsigned who)
+{
+  const unsigned me = (unsigned long)p;
+  int acc           = 0;
+  unsigned first, last;
+
+  if (policy == SCHED_STATIC) {
+    if (chunk == 0)
+      do_owned_tiles (me, &acc, who);
+    else
+      for (first = me * chunk; first < loop.nb; first += nbWorkers * chunk)
+        do_iterations (first,
+                       (first + chunk < loop.nb ? first + chunk : loop.nb),
+                       &acc, who);
+  } else
+    while (next_chunk (&first, &last))
+      do_iterations (first, last, &acc, who);
+
+  partial[me].value = acc;
+}
+
+int scheduler_parallel_for_tile_subset (tile_func_t fn, reduction_t red,
+                                        unsigned ox, unsigned oy,
+                                        unsigned step)
+{
+  int result = 0;
+
+  loop.fn   = fn;
+  loop.red  = red;
+  loop.ox   = ox;
+  loop.oy   = oy;
+  loop.step = step;
+  loop.nx   = (ox < NB_TILES_X ? (NB_TILES_X - ox + step - 1) / step : 0);
+  loop.ny   = (oy < NB_TILES_Y ? (NB_TILES_Y - oy + step - 1) / step : 0);
+  loop.nb   = loop.nx * loop.ny;
+  loop.next = 0;
+
+  // Task i works on behalf of worker i. Static schedules pin task i to
+  // worker i, so that each worker keeps the same tiles from one loop to the
+  // next. Other schedules balance the load, so their tasks may be stolen.
+  if (policy == SCHED_STATIC)
+    create_task_per_worker (loop_task);
+  else
+    scheduler_create_tasks (loop_task, NULL, 1, nbWorkers, -1);
+  scheduler_task_wait ();
+
+  for (int w = 0; w < nbWorkers; w++)
+    if (red == REDUCTION_SUM)
+      result += partial[w].value;
+    else
+      result |= partial[w].value;
+
+  return result;
+}
+
+int scheduler_parallel_for_tiles (tile_func_t fn, reduction_t red)
+{
+  return scheduler_parallel_for_tile_subset (fn, red, 0, 0, 1);
 }
 
 unsigned scheduler_init (unsigned default_P)
@@ -154,7 +777,12 @@ unsigned scheduler_init (unsigned default_P)
   /* Perform the topology detection. */
   hwloc_topology_load (topology);
 
-  nb_cores = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_PU);
+  nb_cores      = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_PU);
+  nb_phys_cores = hwloc_get_nbobjs_by_type (topology, HWLOC_OBJ_CORE);
+  if (nb_phys_cores == 0)
+    nb_phys_cores = nb_cores;
+
+  parse_policy ();
 
   if (default_P != -1)
     nbWorkers = default_P;
@@ -163,21 +791,30 @@ unsigned scheduler_init (unsigned default_P)
   
   PRINT_DEBUG ('s', "[Starting %d workers]\n", nbWorkers);
 
-  workers = malloc (nbWorkers * sizeof (struct worker));
+  workers  = aligned_alloc (64, nbWorkers * sizeof (struct worker));
+  partial  = aligned_alloc (64, nbWorkers * sizeof (*partial));
+
+  placement_init ();
+  finished = 0;
 
   for (i = 0; i < nbWorkers; i++) {
-    workers[i].id   = i;
-    workers[i].fin  = 0;
-    workers[i].todo = 0;
-    workers[i].d    = 0;
-    workers[i].f    = 0;
-    pthread_cond_init (&workers[i].cond, NULL);
+    workers[i].id     = i;
+    workers[i].seed   = i + 1;
+    workers[i].top    = 0;
+    workers[i].bottom = 0;
+    workers[i].array  = task_array_alloc (DEQUE_INIT_SIZE, NULL);
+    workers[i].spare  = NULL;
+    workers[i].head   = segment_alloc (&workers[i]);
+    workers[i].tail   = workers[i].head;
+    workers[i].todo   = 0;
     pthread_mutex_init (&workers[i].mutex, NULL);
     pthread_attr_init (&workers[i].attr);
+  }
 
+  // Workers may steal from each other as soon as they start
+  for (i = 0; i < nbWorkers; i++)
     pthread_create (&workers[i].tid, &workers[i].attr, worker_main,
                     &workers[i]);
-  }
 
   return nbWorkers;
 }
@@ -186,13 +823,28 @@ void scheduler_finalize (void)
 {
   int i;
 
-  for (i = 0; i < nbWorkers; i++)
-    no_more_task (i);
+  __atomic_store_n (&finished, 1, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch (&work_seq, 1, __ATOMIC_SEQ_CST);
+  park_wake (&work_seq, INT_MAX);
 
   for (i = 0; i < nbWorkers; i++)
     pthread_join (workers[i].tid, NULL);
 
+  for (i = 0; i < nbWorkers; i++) {
+    for (struct task_array *a = workers[i].array, *prev; a != NULL; a = prev) {
+      prev = a->prev;
+      free (a);
+    }
+    for (struct segment *seg = workers[i].head, *next; seg != NULL; seg = next) {
+      next = seg->next;
+      free (seg);
+    }
+    free (workers[i].spare);
+  }
+
   free (workers);
+  free (partial);
+  placement_finalize ();
 
   /* Destroy topology object. */
   hwloc_topology_destroy (topology);
@@ -0,0 +1,66 @@
+
+#include "spin_barrier.h"
+#include "park.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+
+#ifndef PTHREAD_BARRIER_SERIAL_THREAD
+#define PTHREAD_BARRIER_SERIAL_THREAD (1)
+#endif
+
+#define SPIN_ROUNDS 256
+
+int spin_barrier_init (spin_barrier_t *barrier, unsigned count)
+{
+  if (count == 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  barrier->count     = count;
+  barrier->sense     = 0;
+  barrier->nb_parked = 0;
+  barrier->limit     = count;
+
+  return 0;
+}
+
+int spin_barrier_single (spin_barrier_t *barrier, void (*f) (void))
+{
+  // The sense cannot change before we arrive
+  int sense = __atomic_load_n (&barrier->sense, __ATOMIC_ACQUIRE);
+
+  if (__atomic_sub_fetch (&barrier->count, 1, __ATOMIC_ACQ_REL) == 0) {
+    barrier->count = barrier->limit;
+    if (f != NULL)
+      f ();
+    __atomic_store_n (&barrier->sense, !sense, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n (&barrier->nb_parked, __ATOMIC_SEQ_CST) > 0)
+      park_wake (&barrier->sense, INT_MAX);
+    return PTHREAD_BARRIER_SERIAL_THREAD;
+  }
+
+  for (int i = 0; i < SPIN_ROUNDS; i++) {
+    if (__atomic_load_n (&barrier->sense, __ATOMIC_ACQUIRE) != sense)
+      return 0;
+    // Let late threads run when cores are oversubscribed
+    if (i < SPIN_ROUNDS / 8)
+      cpu_relax ();
+    else
+      sched_yield ();
+  }
+
+  __atomic_add_fetch (&barrier->nb_parked, 1, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n (&barrier->sense, __ATOMIC_SEQ_CST) == sense)
+    park_wait (&barrier->sense, sense);
+  __atomic_sub_fetch (&barrier->nb_parked, 1, __ATOMIC_SEQ_CST);
+
+  return 0;
+}
+
+int spin_barrier_wait (spin_barrier_t *barrier)
+{
+  return spin_barrier_single (barrier, NULL);
+}
@@ -0,0 +1,113 @@
+
+#include "team.h"
+#include "global.h"
+#include "spin_barrier.h"
+
+#include <omp.h>
+
+static int enabled = 0;
+
+static spin_barrier_t barrier;
+
+// Set by any thread which sees a change, reset by the last thread reaching
+// the end of an iteration. Only written when set, so that it does not
+// bounce between caches when many tiles change.
+static int changed __attribute__ ((aligned (SPIN_BARRIER_LINE))) = 0;
+
+// Written by the last thread of an iteration, read by all after the barrier
+static int stop = 0;
+static unsigned result;
+
+static unsigned cur_iter, last_iter;
+static void (*end_func) (void) = NULL;
+
+void team_init (void)
+{
+  enabled = 1;
+}
+
+void team_finalize (void)
+{
+  enabled = 0;
+}
+
+int team_enabled (void)
+{
+  return enabled;
+}
+
+void team_barrier (void)
+{
+  spin_barrier_wait (&barrier);
+}
+
+void team_changed (void)
+{
+  if (!__atomic_load_n (&changed, __ATOMIC_RELAXED))
+    __atomic_store_n (&changed, 1, __ATOMIC_RELAXED);
+}
+
+void team_for_tile_subset (tile_func_t fn, unsigned ox, unsigned oy,
+                           unsigned step)
+{
+  const int who = omp_get_thread_num ();
+  int change    = 0;
+
+  // Orphaned worksharing: binds to the region opened by team_run
+#pragma omp for collapse(2) schedule(runtime) nowait
+  for (int ty = oy; ty < NB_TILES_Y; ty += step)
+    for (int tx = ox; tx < NB_TILES_X; tx += step)
+      change |= fn (tx * TILE_W, ty * TILE_H, TILE_W, TILE_H, who);
+
+  if (change)
+    team_changed ();
+}
+
+void team_for_tiles (tile_func_t fn)
+{
+  team_for_tile_subset (fn, 0, 0, 1);
+}
+
+// Called by the last thread to reach the end of an iteration
+static void end_of_iteration (void)
+{
+  if (end_func != NULL)
+    end_func ();
+
+  if (!changed) {
+    result = cur_iter;
+    stop   = 1;
+  } else if (cur_iter == last_iter) {
+    result = 0;
+    stop   = 1;
+  } else
+    cur_iter++;
+
+  changed = 0;
+}
+
+unsigned team_run (unsigned nb_iter, void (*body) (void),
+                   void (*end_of_iter) (void))
+{
+  if (nb_iter == 0)
+    return 0;
+
+  cur_iter  = 1;
+  last_iter = nb_iter;
+  end_func  = end_of_iter;
+  changed   = 0;
+  stop      = 0;
+
+#pragma omp parallel
+  {
+#pragma omp single
+    spin_barrier_init (&barrier, omp_get_num_threads ());
+
+    do {
+      body ();
+      spin_barrier_single (&barrier, end_of_iteration);
+    } while (!stop);
+  }
+
+  return result;
+}
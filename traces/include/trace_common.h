@@ -17,6 +17,7 @@ extern unsigned gpu_index[];
 #define TRACE_LABEL        0x108
 #define TRACE_TASKID_COUNT 0x109
 #define TRACE_TASKID       0x10A
+#define TRACE_METRIC       0x10B
 
 #define DEFAULT_EZV_TRACE_DIR "traces/data"
 #define DEFAULT_EZV_TRACE_BASE "ezv_trace_current"
@@ -1,25 +1,31 @@
 #ifndef TRACE_DATA_IS_DEF
 #define TRACE_DATA_IS_DEF
 
-#include "list.h"
 #include "trace_common.h"
 
+#include <stddef.h>
+
 typedef struct
 {
   long start_time, end_time;
   unsigned x, y, w, h;
-  int task_type;
-  int task_id;
   unsigned iteration;
-  struct list_head cpu_chain;
+  unsigned task_type : TASK_TYPE_BITS;
+  unsigned task_id : 32 - TASK_TYPE_BITS;
 } trace_task_t;
 
+// Tasks of a CPU are stored contiguously, by increasing end time
+typedef struct
+{
+  trace_task_t *task;
+  unsigned nb_tasks, max_tasks;
+} trace_cpu_t;
+
 typedef struct
 {
   long start_time, end_time;
   long correction, gap;
-  struct list_head chain;
-  trace_task_t **first_cpu_task;
+  unsigned *first_cpu_task; // index in per_cpu[c].task
 } trace_iteration_t;
 
 typedef struct
@@ -29,11 +35,14 @@ typedef struct
   unsigned nb_cores;
   unsigned nb_gpu;
   unsigned nb_iterations;
+  unsigned max_iterations;
   char *label;
   char **task_ids;
   unsigned task_ids_count;
-  struct list_head *per_cpu;
+  trace_cpu_t *per_cpu;
   trace_iteration_t *iteration;
+  void *map; // tasks and index are mapped from an indexed file
+  size_t map_size;
 } trace_t;
 
 #define MAX_TRACES 2
@@ -51,6 +60,9 @@ void trace_data_set_label (trace_t *tr, char *label);
 void trace_data_alloc_task_ids (trace_t *tr, unsigned count);
 void trace_data_add_taskid (trace_t *tr, char *id);
 
+// Optional: avoids reallocations when the number of tasks is known
+void trace_data_reserve_tasks (trace_t *tr, unsigned cpu, unsigned nb_tasks);
+
 void trace_data_add_task (trace_t *tr, long start_time, long end_time,
                           unsigned x, unsigned y, unsigned w, unsigned h,
                           unsigned iteration, unsigned cpu,
@@ -65,8 +77,14 @@ void trace_data_sync_iterations (void);
 
 void trace_data_finalize (void);
 
-#define for_all_tasks(tr, cpu, var)                                            \
-  list_for_each_entry (trace_task_t, var, (tr)->per_cpu + (cpu), cpu_chain)
+#define for_tasks_from(tr, cpu, first, var)                                    \
+  for (trace_task_t *var = (tr)->per_cpu[cpu].task + (first);                  \
+       var < (tr)->per_cpu[cpu].task + (tr)->per_cpu[cpu].nb_tasks; var++)
+
+#define for_all_tasks(tr, cpu, var) for_tasks_from (tr, cpu, 0, var)
+
+// Index of the first task of cpu which ends at or after t
+unsigned trace_data_search_task (trace_t *tr, unsigned cpu, long t);
 
 int trace_data_search_iteration (trace_t *tr, long t);
 int trace_data_search_next_iteration (trace_t *tr, long t);
@@ -0,0 +1,93 @@
+#ifndef TRACE_EVT_IS_DEF
+#define TRACE_EVT_IS_DEF
+
+#include <stdint.h>
+
+// Native .evt trace format
+//
+// A trace file starts with an evt_file_header_t, followed by a sequence of
+// blocks. Each block is an evt_block_t header immediately followed by
+// 'size' bytes of payload:
+//
+//  EVT_BLOCK_HEADER  : one evt_header_t (always the first block)
+//  EVT_BLOCK_LABEL   : the trace label, NUL-terminated
+//  EVT_BLOCK_TASKIDS : 'count' NUL-terminated task names, task id 0 first
+//  EVT_BLOCK_EVENTS  : an array of evt_record_t produced by a single thread,
+//                      in the order they were recorded
+//  EVT_BLOCK_METRICS : 'count' NUL-terminated metric names, metric 0 first
+//
+// Blocks of events from different threads are interleaved in the file
+// (they are written asynchronously, whenever a thread buffer fills up), so
+// readers must sort records by time. Each record describes a whole
+// interval: an iteration (code TRACE_END_ITER) or a tile (TRACE_END_TILE).
+// Records with code TRACE_METRIC are evt_metric_t instead: the amount of
+// work counted during the iteration which just ended (see
+// include/metrics.h).
+//
+// Times are raw clock ticks (TSC or CLOCK_MONOTONIC_RAW nanoseconds). A
+// tick t is converted to µs, in the time base of gettimeofday, with:
+//
+//   us = origin_us + (t - origin_ticks) * calib_ns / (calib_ticks * 1000)
+//
+// All integers are stored in the byte order of the recording machine.
+
+#define EVT_MAGIC "EZV-EVT"
+#define EVT_VERSION 1
+
+typedef struct
+{
+  char magic[8]; // EVT_MAGIC, NUL-terminated
+  uint32_t version;
+  uint32_t record_size; // sizeof (evt_record_t)
+} evt_file_header_t;
+
+enum
+{
+  EVT_BLOCK_HEADER = 1,
+  EVT_BLOCK_LABEL,
+  EVT_BLOCK_TASKIDS,
+  EVT_BLOCK_EVENTS,
+  EVT_BLOCK_METRICS
+};
+
+typedef struct
+{
+  uint32_t type;
+  uint32_t count; // number of records or strings
+  uint64_t size;  // payload size in bytes
+} evt_block_t;
+
+typedef struct
+{
+  uint32_t nb_cpu;
+  uint32_t nb_gpu_lanes;
+  uint32_t dim;
+  uint32_t reserved;
+  uint64_t calib_ticks; // calib_ticks ticks last calib_ns nanoseconds
+  uint64_t calib_ns;
+  uint64_t origin_ticks; // same instant in both time bases
+  int64_t origin_us;
+} evt_header_t;
+
+typedef struct
+{
+  uint64_t start, end; // ticks
+  uint16_t x, y, w, h;
+  uint16_t code; // TRACE_END_ITER or TRACE_END_TILE
+  uint16_t cpu;
+  uint32_t task; // TASK_COMBINE (task_type, task_id)
+} evt_record_t;
+
+// Same size as evt_record_t, code and cpu at the same place
+typedef struct
+{
+  uint64_t time; // ticks
+  uint64_t value;
+  uint16_t metric; // index in the EVT_BLOCK_METRICS names
+  uint16_t reserved[3];
+  uint16_t code; // TRACE_METRIC
+  uint16_t cpu;
+  uint32_t reserved2;
+} evt_metric_t;
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef TRACE_INDEX_IS_DEF
+#define TRACE_INDEX_IS_DEF
+
+#include <stdint.h>
+
+#include "trace_data.h"
+
+// Indexed trace format (.idx), produced by ezv_convert from .evt (or fxt)
+// traces, and mapped in memory by easyview instead of being parsed.
+//
+// The file starts with an idx_header_t. Then come, at the offsets given by
+// the header (all multiple of 64):
+//
+//  label     : NUL-terminated string
+//  task_ids  : task_ids_count NUL-terminated strings, task id 0 first
+//  iterations: nb_iterations idx_iteration_t
+//  index     : nb_iterations x nb_cores uint32_t: entry (i, c) is the index
+//              of the first task of CPU c belonging to iteration i or later
+//  cpus      : nb_cores idx_cpu_t, locating the task array of each CPU
+//  tasks     : trace_task_t arrays, by increasing end time
+//
+// Times are in µs, already corrected for tracing overhead. Like .evt files,
+// the format is tied to the byte order (and trace_task_t layout) of the
+// machine which produced it.
+
+#define IDX_MAGIC "EZV-IDX"
+#define IDX_VERSION 1
+#define IDX_EXT ".idx"
+
+typedef struct
+{
+  char magic[8]; // IDX_MAGIC, NUL-terminated
+  uint32_t version;
+  uint32_t task_size; // sizeof (trace_task_t)
+  uint32_t nb_cores;  // including GPU lanes
+  uint32_t nb_gpu;
+  uint32_t dim;
+  uint32_t nb_iterations;
+  uint32_t task_ids_count;
+  uint32_t reserved;
+  uint64_t label_offset;
+  uint64_t task_ids_offset;
+  uint64_t iterations_offset;
+  uint64_t index_offset;
+  uint64_t cpus_offset;
+  uint64_t file_size;
+} idx_header_t;
+
+typedef struct
+{
+  int64_t start_time, end_time;
+} idx_iteration_t;
+
+typedef struct
+{
+  uint64_t offset; // of the first trace_task_t
+  uint64_t nb_tasks;
+} idx_cpu_t;
+
+// Writes a trace loaded by trace_file_load
+void trace_index_write (trace_t *tr, char *file);
+
+// Maps an indexed trace file into tr. Returns 0 if file is not an indexed
+// trace.
+int trace_index_map (trace_t *tr, char *file);
+
+void trace_index_unmap (trace_t *tr);
+
+#endif
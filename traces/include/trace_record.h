@@ -1,6 +1,8 @@
 #ifndef TRACE_RECORD_IS_DEF
 #define TRACE_RECORD_IS_DEF
 
+#include <stdint.h>
+
 #include "trace_common.h"
 
 #ifdef ENABLE_TRACE
@@ -11,36 +13,55 @@ void trace_record_init (char *file, unsigned cpu, unsigned gpu, unsigned dim,
                         char *label);
 void trace_record_declare_task_ids (char *task_ids[]);
 void trace_record_commit_task_ids (void);
-void __trace_record_start_iteration (long time);
-void __trace_record_end_iteration (long time);
-void __trace_record_start_tile (long time, unsigned cpu);
-void __trace_record_end_tile (long time, unsigned cpu, unsigned x, unsigned y,
+// Timestamps are taken by the recorder itself
+void __trace_record_start_iteration (void);
+void __trace_record_end_iteration (void);
+void __trace_record_start_tile (unsigned cpu);
+void __trace_record_end_tile (unsigned cpu, unsigned x, unsigned y,
                               unsigned w, unsigned h, int task_type,
                               int task_id);
+// start and end are given in µs (see what_time_is_it)
+void __trace_record_gpu_tile (long start, long end, unsigned cpu, unsigned x,
+                              unsigned y, unsigned w, unsigned h,
+                              int task_type);
+// Records the value of nb counters (see include/metrics.h)
+void __trace_record_metrics (unsigned nb, char *names[], uint64_t values[]);
 void trace_record_finalize (void);
 
-#define trace_record_start_iteration(t)                                        \
+#define trace_record_start_iteration()                                         \
+  do {                                                                         \
+    if (do_trace)                                                              \
+      __trace_record_start_iteration ();                                       \
+  } while (0)
+
+#define trace_record_end_iteration()                                           \
+  do {                                                                         \
+    if (do_trace)                                                              \
+      __trace_record_end_iteration ();                                         \
+  } while (0)
+
+#define trace_record_start_tile(c)                                             \
   do {                                                                         \
     if (do_trace)                                                              \
-      __trace_record_start_iteration (t);                                      \
+      __trace_record_start_tile ((c));                                         \
   } while (0)
 
-#define trace_record_end_iteration(t)                                          \
+#define trace_record_end_tile(c, x, y, w, h, tt, tid)                          \
   do {                                                                         \
     if (do_trace)                                                              \
-      __trace_record_end_iteration (t);                                        \
+      __trace_record_end_tile ((c), (x), (y), (w), (h), (tt), (tid));          \
   } while (0)
 
-#define trace_record_start_tile(t, c)                                          \
+#define trace_record_gpu_tile(s, e, c, x, y, w, h, tt)                         \
   do {                                                                         \
     if (do_trace)                                                              \
-      __trace_record_start_tile ((t), (c));                                    \
+      __trace_record_gpu_tile ((s), (e), (c), (x), (y), (w), (h), (tt));       \
   } while (0)
 
-#define trace_record_end_tile(t, c, x, y, w, h, tt, tid)                       \
+#define trace_record_metrics(n, names, v)                                      \
   do {                                                                         \
     if (do_trace)                                                              \
-      __trace_record_end_tile ((t), (c), (x), (y), (w), (h), (tt), (tid));     \
+      __trace_record_metrics ((n), (names), (v));                              \
   } while (0)
 
 #else
@@ -48,10 +69,12 @@ void trace_record_finalize (void);
 #define do_trace (unsigned)0
 
 #define trace_record_declare_task_ids(a) (void)0
-#define trace_record_start_iteration(t) (void)0
-#define trace_record_end_iteration(t) (void)0
-#define trace_record_start_tile(t, c) (void)0
-#define trace_record_end_tile(t, c, x, y, w, h, tt, tid) (void)0
+#define trace_record_start_iteration() (void)0
+#define trace_record_end_iteration() (void)0
+#define trace_record_start_tile(c) (void)0
+#define trace_record_end_tile(c, x, y, w, h, tt, tid) (void)0
+#define trace_record_gpu_tile(s, e, c, x, y, w, h, tt) (void)0
+#define trace_record_metrics(n, names, v) (void)0
 
 #endif
 
@@ -4,6 +4,7 @@
 
 #include "error.h"
 #include "trace_data.h"
+#include "trace_index.h"
 
 #define min(a, b) ((a) < (b) ? (a) : (b))
 #define max(a, b) ((a) > (b) ? (a) : (b))
@@ -27,21 +28,24 @@ static long fixed_gap          = 0;
 #define shift(t) (t)
 #endif
 
-static LIST_HEAD (tmp_list);
-static trace_iteration_t *current_it = NULL;
+#define MIN_TASKS 1024
+#define MIN_ITERATIONS 64
 
 void trace_data_init (trace_t *tr, unsigned num)
 {
   overhead           = 0;
   end_last_iteration = 0;
   fixed_gap          = 0;
-  current_it         = NULL;
 
   tr->num            = num;
   tr->nb_cores       = 1;
   tr->nb_gpu         = 0;
   tr->per_cpu        = NULL;
   tr->nb_iterations  = 0;
+  tr->max_iterations = 0;
+  tr->iteration      = NULL;
+  tr->map            = NULL;
+  tr->map_size       = 0;
   tr->label          = NULL;
   tr->task_ids       = NULL;
   tr->task_ids_count = 0;
@@ -51,9 +55,7 @@ void trace_data_set_nb_threads (trace_t *tr, unsigned nb_cores, unsigned nb_gpu)
 {
   tr->nb_cores = nb_cores + nb_gpu;
   tr->nb_gpu   = nb_gpu;
-  tr->per_cpu  = malloc (tr->nb_cores * sizeof (trace_task_t));
-  for (int i = 0; i < tr->nb_cores; i++)
-    INIT_LIST_HEAD (tr->per_cpu + i);
+  tr->per_cpu  = calloc (tr->nb_cores, sizeof (trace_cpu_t));
 }
 
 void trace_data_set_dim (trace_t *tr, unsigned dim)
@@ -82,12 +84,31 @@ void trace_data_add_taskid (trace_t *tr, char *id)
   strcpy (tr->task_ids[i], id);
 }
 
+void trace_data_reserve_tasks (trace_t *tr, unsigned cpu, unsigned nb_tasks)
+{
+  trace_cpu_t *c = tr->per_cpu + cpu;
+
+  if (nb_tasks > c->max_tasks) {
+    c->max_tasks = nb_tasks;
+    c->task      = realloc (c->task, c->max_tasks * sizeof (trace_task_t));
+    if (c->task == NULL)
+      exit_with_error ("Cannot allocate %u tasks for CPU %u", c->max_tasks,
+                       cpu);
+  }
+}
+
 void trace_data_add_task (trace_t *tr, long start_time, long end_time,
                           unsigned x, unsigned y, unsigned w, unsigned h,
                           unsigned iteration, unsigned cpu,
                           task_type_t task_type, int task_id)
 {
-  trace_task_t *t = malloc (sizeof (trace_task_t));
+  trace_cpu_t *c = tr->per_cpu + cpu;
+
+  if (c->nb_tasks == c->max_tasks)
+    trace_data_reserve_tasks (tr, cpu,
+                              c->max_tasks ? 2 * c->max_tasks : MIN_TASKS);
+
+  trace_task_t *t = c->task + c->nb_tasks++;
 
   t->start_time = shift (start_time);
   t->end_time   = shift (end_time);
@@ -98,11 +119,6 @@ void trace_data_add_task (trace_t *tr, long start_time, long end_time,
   t->iteration  = iteration;
   t->task_type  = task_type;
   t->task_id    = task_id;
-
-  list_add_tail (&t->cpu_chain, tr->per_cpu + cpu);
-
-  if (current_it->first_cpu_task[cpu] == NULL)
-    current_it->first_cpu_task[cpu] = t;
 }
 
 static void trace_data_display_all (trace_t *tr)
@@ -116,49 +132,51 @@ static void trace_data_display_all (trace_t *tr)
 
       // We get a pointer on the first task of the current iteration executed by
       // CPU 'c'
-      trace_task_t *first = tr->iteration[it].first_cpu_task[c];
-
-      if (first != NULL)
-        // We follow the list of tasks, starting from this first task
-        list_for_each_entry_from (trace_task_t, t, tr->per_cpu + c, first,
-                                  cpu_chain)
-        {
-          // We stop if we encounter a task belonging to a greater iteration
-          if (t->iteration > it + 1)
-            break;
-
-          printf ("Task: time [%lu-%lu], tile [%d, %d, %d, %d], iteration %d\n",
-                  task_start_time (tr, t), task_end_time (tr, t), t->x, t->y,
-                  t->w, t->h, t->iteration);
-        }
+      unsigned first = tr->iteration[it].first_cpu_task[c];
+
+      // We follow the array of tasks, starting from this first task
+      for_tasks_from (tr, c, first, t)
+      {
+        // We stop if we encounter a task belonging to a greater iteration
+        if (t->iteration > it + 1)
+          break;
+
+        printf ("Task: time [%lu-%lu], tile [%d, %d, %d, %d], iteration %d\n",
+                task_start_time (tr, t), task_end_time (tr, t), t->x, t->y,
+                t->w, t->h, t->iteration);
+      }
     }
   }
 }
 
 void trace_data_start_iteration (trace_t *tr, long start_time)
 {
-  tr->nb_iterations++;
+  if (tr->nb_iterations == tr->max_iterations) {
+    tr->max_iterations =
+        tr->max_iterations ? 2 * tr->max_iterations : MIN_ITERATIONS;
+    tr->iteration = realloc (tr->iteration, tr->max_iterations *
+                                                sizeof (trace_iteration_t));
+  }
+
+  trace_iteration_t *current_it = tr->iteration + tr->nb_iterations++;
 
   // printf ("Iteration %d : start %lu -> ", tr->nb_iterations, start_time);
 #ifdef REMOVE_OVERHEAD
   overhead += shift (start_time) - end_last_iteration - fixed_gap;
 #endif
 
-  current_it                 = malloc (sizeof (trace_iteration_t));
   current_it->correction     = 0;
   current_it->gap            = 0;
   current_it->start_time     = shift (start_time);
-  current_it->first_cpu_task = malloc (tr->nb_cores * sizeof (trace_task_t *));
-  for (int c = 0; c < tr->nb_cores; c++)
-    current_it->first_cpu_task[c] = NULL;
-
-  list_add_tail (&current_it->chain, &tmp_list);
+  current_it->first_cpu_task = NULL;
 
   // printf ("%lu\n", current_it->start_time);
 }
 
 void trace_data_end_iteration (trace_t *tr, long end_time)
 {
+  trace_iteration_t *current_it = tr->iteration + tr->nb_iterations - 1;
+
   current_it->end_time = shift (end_time);
 #ifdef REMOVE_OVERHEAD
   end_last_iteration = current_it->end_time;
@@ -172,39 +190,83 @@ void trace_data_end_iteration (trace_t *tr, long end_time)
   // end_last_iteration);
 }
 
+// Index of the first task of cpu which belongs to iteration it or later
+static unsigned search_first_task (trace_cpu_t *c, unsigned it)
+{
+  unsigned first = 0;
+  unsigned last  = c->nb_tasks;
+
+  while (first < last) {
+    unsigned middle = (first + last) / 2;
+    if (c->task[middle].iteration < it)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+
+  return first;
+}
+
 void trace_data_no_more_data (trace_t *tr)
 {
-  unsigned cpt  = 0;
-  tr->iteration = malloc (tr->nb_iterations * sizeof (trace_iteration_t));
-
-  // Now we know the number of iterations: we copy the list' elements
-  // into an array, and we delete the list
-  list_for_each_entry_safe (trace_iteration_t, pos, &tmp_list, chain)
-  {
-    list_del (&pos->chain);
-    tr->iteration[cpt] = *pos;
-    free (pos);
-    cpt++;
+  // Give back the unused part of arrays
+  if (tr->nb_iterations > 0)
+    tr->iteration =
+        realloc (tr->iteration, tr->nb_iterations * sizeof (trace_iteration_t));
+  for (int c = 0; c < tr->nb_cores; c++)
+    if (tr->per_cpu[c].nb_tasks > 0)
+      tr->per_cpu[c].task = realloc (
+          tr->per_cpu[c].task, tr->per_cpu[c].nb_tasks * sizeof (trace_task_t));
+
+  // iteration[i].first_cpu_task[c] is the index of the first task of CPU c
+  // belonging to iteration i or later. In other words, it can point to a task
+  // belonging to an iteration j > i, or past the end of the array.
+  for (int i = 0; i < tr->nb_iterations; i++) {
+    tr->iteration[i].first_cpu_task = malloc (tr->nb_cores * sizeof (unsigned));
+    for (int c = 0; c < tr->nb_cores; c++)
+      tr->iteration[i].first_cpu_task[c] =
+          search_first_task (tr->per_cpu + c, i);
   }
+}
 
-  // We now finalize 'first_cpu_task' arrays so that
-  // iteration[i].first_cpu_task[c] points on the first task the starting time
-  // of which is greater or equal to start time of iteration i. In other words,
-  // iteration[i].first_cpu_task[c] can point on a task belonging to an
-  // iteration j > i.
-  if (tr->nb_iterations > 1) {
-    for (int i = tr->nb_iterations - 2; i >= 0; i--) {
+void trace_data_finalize (void)
+{
+  for (int n = 0; n < nb_traces; n++) {
+    trace_t *tr = trace + n;
+
+    if (tr->map != NULL)
+      trace_index_unmap (tr);
+    else {
+      for (int i = 0; i < tr->nb_iterations; i++)
+        free (tr->iteration[i].first_cpu_task);
       for (int c = 0; c < tr->nb_cores; c++)
-        if (tr->iteration[i].first_cpu_task[c] == NULL)
-          tr->iteration[i].first_cpu_task[c] =
-              tr->iteration[i + 1].first_cpu_task[c];
+        free (tr->per_cpu[c].task);
     }
+    free (tr->iteration);
+    free (tr->per_cpu);
+
+    for (int i = 0; i < tr->task_ids_count; i++)
+      free (tr->task_ids[i]);
+    free (tr->task_ids);
+    free (tr->label);
   }
 }
 
-void trace_data_finalize (void)
+unsigned trace_data_search_task (trace_t *tr, unsigned cpu, long t)
 {
-  // TODO: Free all memory!
+  trace_cpu_t *c = tr->per_cpu + cpu;
+  unsigned first = 0;
+  unsigned last  = c->nb_tasks;
+
+  while (first < last) {
+    unsigned middle = (first + last) / 2;
+    if (task_end_time (tr, c->task + middle) < t)
+      first = middle + 1;
+    else
+      last = middle;
+  }
+
+  return first;
 }
 
 int trace_data_search_iteration (trace_t *tr, long t)
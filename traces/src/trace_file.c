@@ -1,24 +1,31 @@
 #include <fcntl.h>
+#ifdef ENABLE_FUT
 #include <fut.h>
 #include <fxt-tools.h>
 #include <fxt.h>
+#endif
 #include <getopt.h>
 #include <libgen.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include "error.h"
 #include "trace_common.h"
 #include "trace_data.h"
+#include "trace_evt.h"
 #include "trace_file.h"
+#include "trace_index.h"
+
+#ifdef ENABLE_FUT
 
 static long *last_start_times = NULL;
 static unsigned current_iteration;
 
-void trace_file_load (char *file)
+static void trace_file_load_fxt (char *file)
 {
   fxt_t fxt;
   fxt_blockev_t evs;
@@ -31,8 +38,6 @@ void trace_file_load (char *file)
 
   current_iteration = 0;
 
-  trace_data_init (&trace[nb_traces], nb_traces);
-
   evs = fxt_blockev_enter (fxt);
 
   while (FXT_EV_OK ==
@@ -104,6 +109,185 @@ void trace_file_load (char *file)
 
   free (last_start_times);
   last_start_times = NULL;
+}
+
+#endif
+
+static evt_header_t header;
+
+static long evt_to_us (uint64_t t)
+{
+  return header.origin_us +
+         (long)((double)(int64_t)(t - header.origin_ticks) * header.calib_ns /
+                (header.calib_ticks * 1000.0));
+}
+
+static int by_end_time (const void *a, const void *b)
+{
+  const evt_record_t *ra = a, *rb = b;
+
+  if (ra->end != rb->end)
+    return ra->end < rb->end ? -1 : 1;
+  if (ra->start != rb->start)
+    return ra->start < rb->start ? -1 : 1;
+  return 0;
+}
+
+static void *read_payload (FILE *f, evt_block_t *b)
+{
+  void *p = malloc (b->size);
+
+  if (fread (p, 1, b->size, f) != b->size)
+    exit_with_error ("Truncated trace file");
+
+  return p;
+}
+
+// Records of all threads are gathered and sorted by end time, so that tasks
+// reach trace_data_add_task in the same order as with fxt traces. Each task
+// is assigned to the iteration which ends after it.
+static void trace_file_load_evt (FILE *f, evt_file_header_t *fh)
+{
+  evt_record_t *rec = NULL, *iter, *tiles;
+  size_t nb_rec = 0, max_rec = 0, nb_iter = 0, nb_tiles = 0;
+  unsigned *per_cpu;
+  evt_block_t b;
+  struct stat st;
+
+  if (fh->version != EVT_VERSION || fh->record_size != sizeof (evt_record_t))
+    exit_with_error ("Unsupported trace format (version %d)", fh->version);
+
+  // The file size gives an upper bound on the number of records
+  if (fstat (fileno (f), &st) == 0) {
+    max_rec = st.st_size / sizeof (evt_record_t);
+    rec     = malloc (max_rec * sizeof (evt_record_t));
+  }
+
+  while (fread (&b, sizeof (b), 1, f) == 1) {
+    switch (b.type) {
+    case EVT_BLOCK_HEADER: {
+      evt_header_t *h = read_payload (f, &b);
+
+      header = *h;
+      free (h);
+      trace_data_set_nb_threads (&trace[nb_traces], header.nb_cpu,
+                                 header.nb_gpu_lanes);
+      trace_data_set_dim (&trace[nb_traces], header.dim);
+      break;
+    }
+
+    case EVT_BLOCK_LABEL: {
+      char *label = read_payload (f, &b);
+
+      trace_data_set_label (&trace[nb_traces], label);
+      free (label);
+      break;
+    }
+
+    case EVT_BLOCK_TASKIDS: {
+      char *names = read_payload (f, &b), *p = names;
+
+      trace_data_alloc_task_ids (&trace[nb_traces], b.count);
+      for (int i = 0; i < b.count; i++) {
+        trace_data_add_taskid (&trace[nb_traces], p);
+        p += strlen (p) + 1;
+      }
+      free (names);
+      break;
+    }
+
+    case EVT_BLOCK_EVENTS:
+      if (nb_rec + b.count > max_rec) {
+        max_rec = (nb_rec + b.count) * 2;
+        rec     = realloc (rec, max_rec * sizeof (evt_record_t));
+      }
+      if (fread (rec + nb_rec, sizeof (evt_record_t), b.count, f) != b.count)
+        exit_with_error ("Truncated trace file");
+      nb_rec += b.count;
+      break;
+
+    default:
+      fseek (f, b.size, SEEK_CUR);
+      break;
+    }
+  }
+
+  fclose (f);
+
+  // Iterations are moved apart, tiles are compacted in place. Metrics are
+  // not displayed.
+  for (size_t r = 0; r < nb_rec; r++)
+    nb_iter += (rec[r].code == TRACE_END_ITER);
+
+  iter  = malloc (nb_iter * sizeof (evt_record_t));
+  tiles = rec;
+  for (size_t r = 0, i = 0; r < nb_rec; r++)
+    if (rec[r].code == TRACE_END_ITER)
+      iter[i++] = rec[r];
+    else if (rec[r].code == TRACE_END_TILE)
+      tiles[nb_tiles++] = rec[r];
+
+  // Tasks arrays are allocated once and for all
+  per_cpu = calloc (trace[nb_traces].nb_cores, sizeof (unsigned));
+  for (size_t r = 0; r < nb_tiles; r++)
+    if (tiles[r].cpu < trace[nb_traces].nb_cores)
+      per_cpu[tiles[r].cpu]++;
+  for (int c = 0; c < trace[nb_traces].nb_cores; c++)
+    trace_data_reserve_tasks (&trace[nb_traces], c, per_cpu[c]);
+  free (per_cpu);
+
+  qsort (iter, nb_iter, sizeof (evt_record_t), by_end_time);
+  qsort (tiles, nb_tiles, sizeof (evt_record_t), by_end_time);
+
+  size_t t = 0;
+  for (unsigned it = 0; it < nb_iter; it++) {
+    trace_data_start_iteration (&trace[nb_traces], evt_to_us (iter[it].start));
+
+    for (; t < nb_tiles && tiles[t].end <= iter[it].end; t++)
+      trace_data_add_task (&trace[nb_traces], evt_to_us (tiles[t].start),
+                           evt_to_us (tiles[t].end), tiles[t].x, tiles[t].y,
+                           tiles[t].w, tiles[t].h, it, tiles[t].cpu,
+                           TASK_EXTRACT_TTYPE (tiles[t].task),
+                           TASK_EXTRACT_TID (tiles[t].task));
+
+    trace_data_end_iteration (&trace[nb_traces], evt_to_us (iter[it].end));
+  }
+
+  if (t < nb_tiles)
+    fprintf (stderr, "Warning: %zu tasks outside of any iteration ignored\n",
+             nb_tiles - t);
+
+  free (iter);
+  free (tiles);
+}
+
+void trace_file_load (char *file)
+{
+  evt_file_header_t fh = {.magic = ""};
+  FILE *f = fopen (file, "r");
+
+  if (f == NULL)
+    exit_with_error ("Cannot open \"%s\" trace file (%s)", file,
+                     strerror (errno));
+
+  trace_data_init (&trace[nb_traces], nb_traces);
+
+  if (fread (&fh, sizeof (fh), 1, f) == 1 &&
+      !strncmp (fh.magic, EVT_MAGIC, sizeof (fh.magic)))
+    trace_file_load_evt (f, &fh);
+  else if (!strncmp (fh.magic, IDX_MAGIC, sizeof (fh.magic))) {
+    fclose (f);
+    trace_index_map (&trace[nb_traces], file);
+  } else {
+    fclose (f);
+#ifdef ENABLE_FUT
+    trace_file_load_fxt (file);
+#else
+    exit_with_error ("\"%s\" is not a native trace file, and easyview was "
+                     "compiled without fxt support",
+                     file);
+#endif
+  }
 
   // Set a default label
   if (trace[nb_traces].label == NULL) {
@@ -115,7 +299,9 @@ void trace_file_load (char *file)
     trace_data_set_label (&trace[nb_traces], name);
   }
 
-  trace_data_no_more_data (&trace[nb_traces]);
+  // Indexed traces are complete already
+  if (trace[nb_traces].map == NULL)
+    trace_data_no_more_data (&trace[nb_traces]);
 
   printf (
       "Trace #%d \"%s\" successfully opened: %d iterations on %d CPUs (%s)\n",
@@ -2,9 +2,6 @@
 #include <SDL_opengl.h>
 #include <SDL_ttf.h>
 #include <fcntl.h>
-#include <fut.h>
-#include <fxt-tools.h>
-#include <fxt.h>
 #include <getopt.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -1032,7 +1029,7 @@ static void trace_graphics_display (void)
     trace_task_t *to_be_emphasized[max_cores];
     SDL_Rect target_tile_rect;
     int target_tile              = 0;
-    trace_task_t *selected_first = NULL;
+    int selected_first           = -1;
     int selected_cpu             = 0;
     unsigned wh                  = trace_display_info[_t].gantt.y + Y_MARGIN;
 
@@ -1082,19 +1079,13 @@ static void trace_graphics_display (void)
     // tiles
     if (first_it < tr->nb_iterations)
       for (int c = 0; c < tr->nb_cores; c++) {
-        // We get a pointer on the first task executed by
-        // CPU 'c' at first displayed iteration
-        trace_task_t *first = tr->iteration[first_it].first_cpu_task[c];
+        // We look for the first task executed by CPU 'c' which is visible
+        unsigned first      = trace_data_search_task (tr, c, start_time);
         unsigned task_color = c % MAX_COLORS;
 
-        if (first != NULL)
-          // We follow the list of tasks, starting from this first task
-          list_for_each_entry_from (trace_task_t, t, tr->per_cpu + c, first,
-                                    cpu_chain)
+        // We follow the array of tasks, starting from this first task
+        for_tasks_from (tr, c, first, t)
           {
-            if (task_end_time (tr, t) < start_time)
-              continue;
-
             // We stop if we encounter a task belonging to a greater iteration
             if (task_start_time (tr, t) > end_time)
               break;
@@ -1121,7 +1112,7 @@ static void trace_graphics_display (void)
             if (mouse_in_gantt_zone) {
 
               if (horiz_mode && point_in_yrange (&dst, my)) {
-                if (selected_first == NULL) {
+                if (selected_first == -1) {
                   selected_first = first;
                   selected_cpu   = c;
                 }
@@ -1181,10 +1172,9 @@ static void trace_graphics_display (void)
       SDL_RenderCopy (renderer, square_tex_dark[MAX_COLORS], NULL,
                       &target_tile_rect);
     else if (horiz_mode) {
-      if (selected_first != NULL)
-        // We follow the list of tasks, starting from this first task
-        list_for_each_entry_from (trace_task_t, t, tr->per_cpu + selected_cpu,
-                                  selected_first, cpu_chain)
+      if (selected_first != -1)
+        // We follow the array of tasks, starting from this first task
+        for_tasks_from (tr, selected_cpu, selected_first, t)
         {
           // Stop if the task has no associated tile
           if (t->w == 0 || t->h == 0)
@@ -0,0 +1,173 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "trace_data.h"
+#include "trace_index.h"
+
+#define IDX_ALIGN 64
+
+static uint64_t align (uint64_t off)
+{
+  return (off + IDX_ALIGN - 1) & ~(uint64_t)(IDX_ALIGN - 1);
+}
+
+static void write_at (int fd, uint64_t offset, const void *data, size_t size)
+{
+  if (pwrite (fd, data, size, offset) != size)
+    exit_with_error ("Cannot write index file (%s)", strerror (errno));
+}
+
+void trace_index_write (trace_t *tr, char *file)
+{
+  idx_header_t h = {.magic          = IDX_MAGIC,
+                    .version        = IDX_VERSION,
+                    .task_size      = sizeof (trace_task_t),
+                    .nb_cores       = tr->nb_cores,
+                    .nb_gpu         = tr->nb_gpu,
+                    .dim            = tr->dimensions,
+                    .nb_iterations  = tr->nb_iterations,
+                    .task_ids_count = tr->task_ids_count};
+  uint64_t off = align (sizeof (h));
+  int fd;
+
+  fd = open (file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd == -1)
+    exit_with_error ("Cannot create \"%s\" index file (%s)", file,
+                     strerror (errno));
+
+  h.label_offset = off;
+  write_at (fd, off, tr->label, strlen (tr->label) + 1);
+  off = align (off + strlen (tr->label) + 1);
+
+  h.task_ids_offset = off;
+  for (int i = 0; i < tr->task_ids_count; i++) {
+    write_at (fd, off, tr->task_ids[i], strlen (tr->task_ids[i]) + 1);
+    off += strlen (tr->task_ids[i]) + 1;
+  }
+  off = align (off);
+
+  h.iterations_offset = off;
+  for (int i = 0; i < tr->nb_iterations; i++) {
+    idx_iteration_t it = {tr->iteration[i].start_time,
+                          tr->iteration[i].end_time};
+    write_at (fd, off, &it, sizeof (it));
+    off += sizeof (it);
+  }
+  off = align (off);
+
+  h.index_offset = off;
+  for (int i = 0; i < tr->nb_iterations; i++) {
+    write_at (fd, off, tr->iteration[i].first_cpu_task,
+              tr->nb_cores * sizeof (uint32_t));
+    off += tr->nb_cores * sizeof (uint32_t);
+  }
+  off = align (off);
+
+  // Task arrays follow the table of CPUs
+  h.cpus_offset     = off;
+  uint64_t task_off = align (off + tr->nb_cores * sizeof (idx_cpu_t));
+
+  for (int c = 0; c < tr->nb_cores; c++) {
+    idx_cpu_t cpu = {task_off, tr->per_cpu[c].nb_tasks};
+
+    write_at (fd, off + c * sizeof (cpu), &cpu, sizeof (cpu));
+    write_at (fd, task_off, tr->per_cpu[c].task,
+              cpu.nb_tasks * sizeof (trace_task_t));
+    task_off = align (task_off + cpu.nb_tasks * sizeof (trace_task_t));
+  }
+
+  h.file_size = task_off;
+  write_at (fd, 0, &h, sizeof (h));
+
+  if (ftruncate (fd, h.file_size) < 0)
+    exit_with_error ("Cannot write index file (%s)", strerror (errno));
+
+  close (fd);
+}
+
+int trace_index_map (trace_t *tr, char *file)
+{
+  idx_header_t *h;
+  struct stat st;
+  int fd;
+
+  fd = open (file, O_RDONLY);
+  if (fd == -1)
+    exit_with_error ("Cannot open \"%s\" trace file (%s)", file,
+                     strerror (errno));
+
+  if (fstat (fd, &st) < 0 || st.st_size < sizeof (idx_header_t)) {
+    close (fd);
+    return 0;
+  }
+
+  h = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (h == MAP_FAILED)
+    exit_with_error ("Cannot map \"%s\" trace file (%s)", file,
+                     strerror (errno));
+
+  if (strncmp (h->magic, IDX_MAGIC, sizeof (h->magic))) {
+    munmap (h, st.st_size);
+    return 0;
+  }
+
+  if (h->version != IDX_VERSION || h->task_size != sizeof (trace_task_t) ||
+      h->file_size > st.st_size)
+    exit_with_error ("\"%s\": unsupported or truncated index file", file);
+
+  // Only the pages of displayed tasks will be read
+  madvise (h, st.st_size, MADV_RANDOM);
+
+  char *base   = (char *)h;
+  tr->map      = h;
+  tr->map_size = st.st_size;
+
+  trace_data_set_nb_threads (tr, h->nb_cores - h->nb_gpu, h->nb_gpu);
+  trace_data_set_dim (tr, h->dim);
+  trace_data_set_label (tr, base + h->label_offset);
+
+  char *name = base + h->task_ids_offset;
+
+  trace_data_alloc_task_ids (tr, h->task_ids_count);
+  for (int i = 0; i < h->task_ids_count; i++) {
+    trace_data_add_taskid (tr, name);
+    name += strlen (name) + 1;
+  }
+
+  idx_cpu_t *cpu = (idx_cpu_t *)(base + h->cpus_offset);
+  for (int c = 0; c < h->nb_cores; c++) {
+    tr->per_cpu[c].task      = (trace_task_t *)(base + cpu[c].offset);
+    tr->per_cpu[c].nb_tasks  = cpu[c].nb_tasks;
+    tr->per_cpu[c].max_tasks = cpu[c].nb_tasks;
+  }
+
+  idx_iteration_t *it = (idx_iteration_t *)(base + h->iterations_offset);
+  uint32_t *index     = (uint32_t *)(base + h->index_offset);
+
+  tr->nb_iterations  = h->nb_iterations;
+  tr->max_iterations = h->nb_iterations;
+  tr->iteration = malloc (h->nb_iterations * sizeof (trace_iteration_t));
+  for (int i = 0; i < h->nb_iterations; i++) {
+    tr->iteration[i].start_time     = it[i].start_time;
+    tr->iteration[i].end_time       = it[i].end_time;
+    tr->iteration[i].correction     = 0;
+    tr->iteration[i].gap            = 0;
+    tr->iteration[i].first_cpu_task = index + i * h->nb_cores;
+  }
+
+  return 1;
+}
+
+void trace_index_unmap (trace_t *tr)
+{
+  munmap (tr->map, tr->map_size);
+  tr->map = NULL;
+}
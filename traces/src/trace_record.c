@@ -12,17 +12,49 @@
 #include <fut.h>
 #define BUFFER_SIZE (16 << 20)
 
+#else
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
 #endif
 
+#include "debug.h"
 #include "error.h"
+#include "time_macros.h"
 #include "trace_common.h"
 #include "trace_data.h"
+#include "trace_evt.h"
 #include "trace_record.h"
 
 unsigned do_trace = 0;
 
 static unsigned task_ids_count = 0;
 
+static void check_task_id (int task_id)
+{
+  if (task_id >= task_ids_count)
+    exit_with_error ("monitoring_end_tile: task id %d is too large (should < %d)%s\n",
+                     task_id, task_ids_count, (task_ids_count == 1) ? ". Probable cause: monitoring_declare_task_ids not called" : "");
+}
+
+void trace_record_commit_task_ids (void)
+{
+  if (task_ids_count == 0) // declare_task_ids not called by user
+    trace_record_declare_task_ids (NULL);
+}
+
+#ifdef ENABLE_FUT
+
+///////////////////////////// FxT backend
+
 void trace_record_init (char *file, unsigned cpu, unsigned gpu, unsigned dim,
                         char *label)
 {
@@ -69,34 +101,421 @@ void trace_record_declare_task_ids (char *task_ids[])
       FUT_PROBESTR (0x1, TRACE_TASKID, task_ids[i]); // task id i + 1
 }
 
-void trace_record_commit_task_ids (void)
+void __trace_record_start_iteration (void)
 {
-  if (task_ids_count == 0) // declare_task_ids not called by user
-    trace_record_declare_task_ids (NULL);
+  FUT_PROBE1 (0x1, TRACE_BEGIN_ITER, what_time_is_it ());
 }
 
-void __trace_record_start_iteration (long time)
+void __trace_record_end_iteration (void)
 {
-  FUT_PROBE1 (0x1, TRACE_BEGIN_ITER, time);
+  FUT_PROBE1 (0x1, TRACE_END_ITER, what_time_is_it ());
 }
 
-void __trace_record_end_iteration (long time)
+void __trace_record_start_tile (unsigned cpu)
 {
-  FUT_PROBE1 (0x1, TRACE_END_ITER, time);
+  FUT_PROBE2 (0x1, TRACE_BEGIN_TILE, what_time_is_it (), cpu);
 }
 
-void __trace_record_start_tile (long time, unsigned cpu)
+void __trace_record_end_tile (unsigned cpu, unsigned x, unsigned y,
+                              unsigned w, unsigned h, int task_type,
+                              int task_id)
+{
+  check_task_id (task_id);
+  FUT_PROBE7 (0x1, TRACE_END_TILE, what_time_is_it (), cpu, x, y, w, h,
+              TASK_COMBINE (task_type, task_id));
+}
+
+void __trace_record_gpu_tile (long start, long end, unsigned cpu, unsigned x,
+                              unsigned y, unsigned w, unsigned h,
+                              int task_type)
+{
+  FUT_PROBE2 (0x1, TRACE_BEGIN_TILE, start, cpu);
+  FUT_PROBE7 (0x1, TRACE_END_TILE, end, cpu, x, y, w, h,
+              TASK_COMBINE (task_type, 0));
+}
+
+// Metrics are only recorded in native traces
+void __trace_record_metrics (unsigned nb, char *names[], uint64_t values[])
 {
-  FUT_PROBE2 (0x1, TRACE_BEGIN_TILE, time, cpu);
 }
 
-void __trace_record_end_tile (long time, unsigned cpu, unsigned x, unsigned y,
+#else
+
+///////////////////////////// Native backend (see trace_evt.h)
+//
+// Each thread appends fixed-size records to its own ring of chunks, without
+// any lock. When a chunk is full, it is handed over to a flusher thread
+// which writes it to the file in the background. The owner only waits if
+// the flusher lags behind by a whole ring.
+
+#define EVT_CHUNK_RECORDS 2048 // 64 KiB
+#define EVT_CHUNKS 8
+#define EVT_MAX_THREADS 1024
+#define EVT_CALIBRATION_NS 10000000UL // 10ms
+#define EVT_FLUSH_PERIOD_NS 1000000L  // 1ms
+
+typedef struct
+{
+  // Owner side
+  evt_record_t *rec; // EVT_CHUNKS chunks of EVT_CHUNK_RECORDS records
+  unsigned cur, pos; // chunk being filled, and next free record in it
+  uint64_t tile_start, iter_start;
+  unsigned nb_stalls;
+  // Flusher side
+  int full[EVT_CHUNKS] __attribute__ ((aligned (64)));
+  unsigned next; // next chunk to write
+} evt_buffer_t;
+
+static int fd = -1;
+static pthread_mutex_t write_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static evt_buffer_t *buffers[EVT_MAX_THREADS];
+static unsigned nb_buffers = 0;
+static __thread evt_buffer_t *my_buffer = NULL;
+
+static pthread_t flusher;
+static int stop_flusher = 0;
+
+static evt_header_t header;
+static int use_tsc = 0;
+
+static inline uint64_t clock_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC_RAW, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static inline uint64_t evt_clock (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  if (use_tsc)
+    return __rdtsc ();
+#endif
+  return clock_ns ();
+}
+
+// The TSC is only usable if it ticks at a constant rate, whatever the
+// frequency and sleep state of cores
+static int tsc_is_invariant (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned a, b, c, d;
+
+  if (__get_cpuid (0x80000000, &a, &b, &c, &d) && a >= 0x80000007 &&
+      __get_cpuid (0x80000007, &a, &b, &c, &d))
+    return (d >> 8) & 1;
+#endif
+  return 0;
+}
+
+static void calibrate (void)
+{
+  use_tsc = tsc_is_invariant ();
+
+  if (use_tsc) {
+    uint64_t ns0 = clock_ns (), t0 = evt_clock (), ns1, t1;
+
+    do {
+      ns1 = clock_ns ();
+      t1  = evt_clock ();
+    } while (ns1 - ns0 < EVT_CALIBRATION_NS);
+
+    header.calib_ticks = t1 - t0;
+    header.calib_ns    = ns1 - ns0;
+  } else
+    header.calib_ticks = header.calib_ns = 1;
+
+  header.origin_ticks = evt_clock ();
+  header.origin_us    = what_time_is_it ();
+
+  PRINT_DEBUG ('m', "Trace clock: %s, %.3f ticks per ns\n",
+               use_tsc ? "TSC" : "CLOCK_MONOTONIC_RAW",
+               (double)header.calib_ticks / header.calib_ns);
+}
+
+static void write_block (uint32_t type, uint32_t count, const void *data,
+                         uint64_t size)
+{
+  evt_block_t b = {.type = type, .count = count, .size = size};
+
+  pthread_mutex_lock (&write_lock);
+  if (write (fd, &b, sizeof (b)) != sizeof (b) ||
+      write (fd, data, size) != size)
+    exit_with_error ("Cannot write trace file (%s)", strerror (errno));
+  pthread_mutex_unlock (&write_lock);
+}
+
+static evt_buffer_t *evt_new_buffer (void)
+{
+  unsigned i = __atomic_fetch_add (&nb_buffers, 1, __ATOMIC_RELAXED);
+
+  if (i >= EVT_MAX_THREADS)
+    exit_with_error ("Too many threads for tracing (max %d)", EVT_MAX_THREADS);
+
+  evt_buffer_t *b = aligned_alloc (64, sizeof (evt_buffer_t));
+
+  memset (b, 0, sizeof (evt_buffer_t));
+  b->rec = malloc (EVT_CHUNKS * EVT_CHUNK_RECORDS * sizeof (evt_record_t));
+
+  __atomic_store_n (&buffers[i], b, __ATOMIC_RELEASE);
+  my_buffer = b;
+
+  return b;
+}
+
+static void evt_next_chunk (evt_buffer_t *b)
+{
+  __atomic_store_n (&b->full[b->cur], 1, __ATOMIC_RELEASE);
+
+  b->cur = (b->cur + 1) % EVT_CHUNKS;
+  b->pos = 0;
+
+  while (__atomic_load_n (&b->full[b->cur], __ATOMIC_ACQUIRE)) {
+    b->nb_stalls++;
+    sched_yield ();
+  }
+}
+
+static inline evt_buffer_t *evt_buffer (void)
+{
+  return my_buffer != NULL ? my_buffer : evt_new_buffer ();
+}
+
+static inline evt_record_t *evt_alloc (evt_buffer_t *b)
+{
+  if (b->pos == EVT_CHUNK_RECORDS)
+    evt_next_chunk (b);
+
+  return b->rec + b->cur * EVT_CHUNK_RECORDS + b->pos++;
+}
+
+// Writes the full chunks of all threads, returns how many
+static unsigned flush_full_chunks (void)
+{
+  unsigned n = __atomic_load_n (&nb_buffers, __ATOMIC_ACQUIRE), done = 0;
+
+  for (unsigned i = 0; i < n && i < EVT_MAX_THREADS; i++) {
+    evt_buffer_t *b = __atomic_load_n (&buffers[i], __ATOMIC_ACQUIRE);
+
+    if (b == NULL) // being registered
+      continue;
+
+    while (__atomic_load_n (&b->full[b->next], __ATOMIC_ACQUIRE)) {
+      write_block (EVT_BLOCK_EVENTS, EVT_CHUNK_RECORDS,
+                   b->rec + b->next * EVT_CHUNK_RECORDS,
+                   EVT_CHUNK_RECORDS * sizeof (evt_record_t));
+      __atomic_store_n (&b->full[b->next], 0, __ATOMIC_RELEASE);
+      b->next = (b->next + 1) % EVT_CHUNKS;
+      done++;
+    }
+  }
+
+  return done;
+}
+
+static void *flusher_main (void *arg)
+{
+  const struct timespec period = {0, EVT_FLUSH_PERIOD_NS};
+
+  while (!__atomic_load_n (&stop_flusher, __ATOMIC_ACQUIRE))
+    if (flush_full_chunks () == 0)
+      nanosleep (&period, NULL);
+
+  return NULL;
+}
+
+void trace_record_init (char *file, unsigned cpu, unsigned gpu, unsigned dim,
+                        char *label)
+{
+  evt_file_header_t fh = {.magic       = EVT_MAGIC,
+                          .version     = EVT_VERSION,
+                          .record_size = sizeof (evt_record_t)};
+
+  if (dim > UINT16_MAX)
+    exit_with_error ("Tracing is limited to DIM < %d", UINT16_MAX + 1);
+
+  fd = open (file, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd == -1)
+    exit_with_error ("Cannot create \"%s\" trace file (%s)", file,
+                     strerror (errno));
+
+  if (write (fd, &fh, sizeof (fh)) != sizeof (fh))
+    exit_with_error ("Cannot write trace file (%s)", strerror (errno));
+
+  calibrate ();
+
+  // We use 2 lanes per GPU : one for computations, the other for data transfers
+  header.nb_cpu       = cpu;
+  header.nb_gpu_lanes = gpu * 2;
+  header.dim          = dim;
+  write_block (EVT_BLOCK_HEADER, 1, &header, sizeof (header));
+
+  if (label != NULL)
+    write_block (EVT_BLOCK_LABEL, 1, label, strlen (label) + 1);
+
+  stop_flusher = 0;
+  if (pthread_create (&flusher, NULL, flusher_main, NULL))
+    exit_with_error ("Cannot create trace flusher thread");
+}
+
+void trace_record_finalize (void)
+{
+  unsigned nb_stalls = 0;
+
+  __atomic_store_n (&stop_flusher, 1, __ATOMIC_RELEASE);
+  pthread_join (flusher, NULL);
+
+  flush_full_chunks ();
+
+  // Computing threads are idle by now: write partially filled chunks
+  for (unsigned i = 0; i < nb_buffers; i++) {
+    evt_buffer_t *b = buffers[i];
+
+    if (b->pos > 0)
+      write_block (EVT_BLOCK_EVENTS, b->pos,
+                   b->rec + b->cur * EVT_CHUNK_RECORDS,
+                   b->pos * sizeof (evt_record_t));
+
+    nb_stalls += b->nb_stalls;
+    free (b->rec);
+    free (b);
+    buffers[i] = NULL;
+  }
+  nb_buffers = 0;
+
+  PRINT_DEBUG ('m', "Trace: %u stall(s) waiting for the flusher\n", nb_stalls);
+
+  close (fd);
+  fd = -1;
+}
+
+void trace_record_declare_task_ids (char *task_ids[])
+{
+  size_t size = sizeof ("anonymous");
+
+  if (!do_trace)
+    return;
+
+  task_ids_count = 1;
+
+  if (task_ids != NULL)
+    for (int i = 0; task_ids[i] != NULL; i++) {
+      task_ids_count++;
+      size += strlen (task_ids[i]) + 1;
+    }
+
+  char *names = malloc (size), *p = names;
+
+  p = stpcpy (p, "anonymous") + 1; // task id 0
+  if (task_ids != NULL)
+    for (int i = 0; task_ids[i] != NULL; i++)
+      p = stpcpy (p, task_ids[i]) + 1; // task id i + 1
+
+  write_block (EVT_BLOCK_TASKIDS, task_ids_count, names, size);
+  free (names);
+}
+
+void __trace_record_start_iteration (void)
+{
+  evt_buffer ()->iter_start = evt_clock ();
+}
+
+void __trace_record_end_iteration (void)
+{
+  evt_buffer_t *b = evt_buffer ();
+  evt_record_t *r = evt_alloc (b);
+
+  r->start = b->iter_start;
+  r->end   = evt_clock ();
+  r->x     = 0;
+  r->y     = 0;
+  r->w     = 0;
+  r->h     = 0;
+  r->code  = TRACE_END_ITER;
+  r->cpu   = 0;
+  r->task  = 0;
+}
+
+void __trace_record_start_tile (unsigned cpu)
+{
+  evt_buffer ()->tile_start = evt_clock ();
+}
+
+static inline void evt_tile (evt_buffer_t *b, uint64_t start, uint64_t end,
+                             unsigned cpu, unsigned x, unsigned y, unsigned w,
+                             unsigned h, unsigned task)
+{
+  evt_record_t *r = evt_alloc (b);
+
+  r->start = start;
+  r->end   = end;
+  r->x     = x;
+  r->y     = y;
+  r->w     = w;
+  r->h     = h;
+  r->code  = TRACE_END_TILE;
+  r->cpu   = cpu;
+  r->task  = task;
+}
+
+void __trace_record_end_tile (unsigned cpu, unsigned x, unsigned y,
                               unsigned w, unsigned h, int task_type,
                               int task_id)
 {
-  if (task_id >= task_ids_count)
-    exit_with_error ("monitoring_end_tile: task id %d is too large (should < %d)%s\n",
-                     task_id, task_ids_count, (task_ids_count == 1) ? ". Probable cause: monitoring_declare_task_ids not called" : "");
-  FUT_PROBE7 (0x1, TRACE_END_TILE, time, cpu, x, y, w, h,
-              TASK_COMBINE (task_type, task_id));
+  uint64_t end    = evt_clock ();
+  evt_buffer_t *b = evt_buffer ();
+
+  check_task_id (task_id);
+  evt_tile (b, b->tile_start, end, cpu, x, y, w, h,
+            TASK_COMBINE (task_type, task_id));
+}
+
+static inline uint64_t us_to_ticks (long us)
+{
+  return header.origin_ticks + (int64_t)((double)(us - header.origin_us) *
+                                         1000.0 * header.calib_ticks /
+                                         header.calib_ns);
 }
+
+void __trace_record_gpu_tile (long start, long end, unsigned cpu, unsigned x,
+                              unsigned y, unsigned w, unsigned h,
+                              int task_type)
+{
+  evt_tile (evt_buffer (), us_to_ticks (start), us_to_ticks (end), cpu, x, y,
+            w, h, TASK_COMBINE (task_type, 0));
+}
+
+void __trace_record_metrics (unsigned nb, char *names[], uint64_t values[])
+{
+  static int names_written = 0;
+  evt_buffer_t *b          = evt_buffer ();
+  uint64_t now             = evt_clock ();
+
+  if (!names_written) {
+    size_t size = 0;
+
+    for (unsigned m = 0; m < nb; m++)
+      size += strlen (names[m]) + 1;
+
+    char *buf = malloc (size), *p = buf;
+
+    for (unsigned m = 0; m < nb; m++)
+      p = stpcpy (p, names[m]) + 1;
+
+    write_block (EVT_BLOCK_METRICS, nb, buf, size);
+    free (buf);
+    names_written = 1;
+  }
+
+  for (unsigned m = 0; m < nb; m++) {
+    evt_metric_t *r = (evt_metric_t *)evt_alloc (b);
+
+    *r = (evt_metric_t){
+        .time = now, .value = values[m], .metric = m, .code = TRACE_METRIC};
+  }
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+#include "trace_data.h"
+#include "trace_file.h"
+#include "trace_index.h"
+
+// Converts traces into the indexed format (see trace_index.h), which
+// easyview maps in memory instead of parsing the whole file at startup.
+//
+// Usage: ezv_convert <trace.evt> [output.idx]
+//
+// By default, the output file is the input file with its extension replaced
+// by .idx
+
+int main (int argc, char **argv)
+{
+  char *output;
+
+  if (argc < 2 || argc > 3) {
+    fprintf (stderr, "Usage: %s <trace file> [output file]\n", argv[0]);
+    exit (EXIT_FAILURE);
+  }
+
+  if (argc == 3)
+    output = argv[2];
+  else {
+    char *dot = strrchr (argv[1], '.');
+    size_t l  = (dot != NULL && strchr (dot, '/') == NULL) ? dot - argv[1]
+                                                           : strlen (argv[1]);
+
+    output = malloc (l + strlen (IDX_EXT) + 1);
+    memcpy (output, argv[1], l);
+    strcpy (output + l, IDX_EXT);
+  }
+
+  if (!strcmp (output, argv[1]))
+    exit_with_error ("Input and output files are the same");
+
+  // trace_file_load may modify its argument when setting the default label
+  char *input = strdup (argv[1]);
+
+  trace_file_load (input);
+
+  trace_index_write (&trace[0], output);
+
+  printf ("Trace written to %s\n", output);
+
+  trace_data_finalize ();
+
+  return EXIT_SUCCESS;
+}